@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+// Round a size up to the arena alignment
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Allocate a new block able to hold at least `size` bytes and make it the current one
+static arena_block *new_block(arena *a, size_t size) {
+    size_t block_size = size > a->block_size ? size : a->block_size;
+    arena_block *block = (arena_block *)malloc(sizeof(arena_block) + block_size);
+    if (block == NULL) {
+        fprintf(stderr, "Memory allocation failed! Arena is full.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    block->size = block_size;
+    block->used = 0;
+    block->next = a->head;
+    a->head = block;
+    a->reserved += sizeof(arena_block) + block_size;
+    return block;
+}
+
+// Initialize an empty arena; blocks are only allocated on first use
+void arena_init(arena *a, size_t block_size) {
+    a->head = NULL;
+    a->block_size = block_size ? block_size : ARENA_BLOCK_SIZE;
+    a->reserved = 0;
+    a->used = 0;
+}
+
+// Allocate `size` bytes aligned to ARENA_ALIGN
+void *arena_alloc(arena *a, size_t size) {
+    size = align_up(size ? size : 1);
+
+    arena_block *block = a->head;
+    if (block == NULL || block->size - block->used < size) {
+        block = new_block(a, size);
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    a->used += size;
+    return ptr;
+}
+
+// Allocate `size` zeroed bytes
+void *arena_calloc(arena *a, size_t size) {
+    void *ptr = arena_alloc(a, size);
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+// Copy at most `n` bytes of a string into the arena
+char *arena_strndup(arena *a, const char *s, size_t n) {
+    size_t length = strnlen(s, n);
+    char *copy = (char *)arena_alloc(a, length + 1);
+    memcpy(copy, s, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Copy a string into the arena
+char *arena_strdup(arena *a, const char *s) {
+    return arena_strndup(a, s, strlen(s));
+}
+
+// Discard all allocations; the largest block is kept so steady-state use does not touch malloc
+void arena_reset(arena *a) {
+    arena_block *keep = NULL;
+    arena_block *block = a->head;
+
+    while (block) {
+        arena_block *next = block->next;
+        if (keep == NULL || block->size > keep->size) {
+            if (keep) {
+                a->reserved -= sizeof(arena_block) + keep->size;
+                free(keep);
+            }
+            keep = block;
+        } else {
+            a->reserved -= sizeof(arena_block) + block->size;
+            free(block);
+        }
+        block = next;
+    }
+
+    if (keep) {
+        keep->used = 0;
+        keep->next = NULL;
+    }
+    a->head = keep;
+    a->used = 0;
+}
+
+// Release every block back to the system
+void arena_free(arena *a) {
+    arena_block *block = a->head;
+    while (block) {
+        arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    a->head = NULL;
+    a->reserved = 0;
+    a->used = 0;
+}
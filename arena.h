@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)  // Default size of a block carved up by the arena
+#define ARENA_ALIGN 16                // Alignment of every allocation
+
+// A block of memory from which allocations are bumped
+typedef struct arena_block {
+    struct arena_block *next;  // Previously filled block
+    size_t size;               // Usable bytes in `data`
+    size_t used;               // Bytes already handed out
+    char data[];               // Storage for allocations
+} arena_block;
+
+// Bump allocator; individual allocations are never freed, the whole arena is reset or freed at once
+typedef struct arena {
+    arena_block *head;   // Block currently being filled
+    size_t block_size;   // Size of newly allocated blocks
+    size_t reserved;     // Total bytes obtained from malloc
+    size_t used;         // Total bytes handed out since the last reset
+} arena;
+
+void arena_init(arena *a, size_t block_size); // Initialize an empty arena (block_size 0 selects ARENA_BLOCK_SIZE)
+void *arena_alloc(arena *a, size_t size); // Allocate `size` bytes aligned to ARENA_ALIGN
+void *arena_calloc(arena *a, size_t size); // Allocate `size` zeroed bytes
+char *arena_strdup(arena *a, const char *s); // Copy a string into the arena
+char *arena_strndup(arena *a, const char *s, size_t n); // Copy at most `n` bytes of a string into the arena
+void arena_reset(arena *a); // Discard all allocations, keeping one block for reuse
+void arena_free(arena *a); // Release every block back to the system
+
+#endif
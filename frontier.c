@@ -0,0 +1,465 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "frontier.h"
+#include "tokenizer.h"
+
+// 32-bit FNV-1a hash of the first `length` bytes of a string
+static uint32_t frontier_hash(const char *s, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Length of the "scheme://host" prefix of a URL
+static size_t host_length(const char *url) {
+    const char *start = strstr(url, "://");
+    start = start ? start + 3 : url;
+    return (size_t)(start - url) + strcspn(start, "/?#");
+}
+
+// Create an empty frontier
+void frontier_init(frontier *f, int max_depth, frontier_score_fn score) {
+    memset(f, 0, sizeof(*f));
+    arena_init(&f->pool, 0);
+    init_hashmap_arena(&f->focus, &f->pool);
+    f->slot_count = FRONTIER_MIN_SLOTS;
+    f->slots = (frontier_entry **)calloc(f->slot_count, sizeof(frontier_entry *));
+    f->max_depth = max_depth;
+    f->score = score ? score : frontier_default_score;
+}
+
+// Add the tokens of a text (such as the seed's title) to the terms that make an anchor relevant
+void frontier_add_focus(frontier *f, const char *text, size_t length) {
+    tokenizer tk;
+    char token[TOKEN_MAX + 1];
+    size_t token_length;
+
+    tokenizer_init(&tk, text, length);
+    while ((token_length = next_token(&tk, token)) > 0) {
+        if (!is_stop_word(token, token_length) && !search_url(&f->focus, token)) {
+            insert_url(&f->focus, token);
+        }
+    }
+}
+
+// Count the focus terms in an anchor text
+unsigned frontier_anchor_hits(frontier *f, const char *text, size_t length) {
+    tokenizer tk;
+    char token[TOKEN_MAX + 1];
+    unsigned hits = 0;
+
+    tokenizer_init(&tk, text, length);
+    while (next_token(&tk, token) > 0) {
+        if (search_url(&f->focus, token)) hits++;
+    }
+    return hits;
+}
+
+// Default policy: well-linked URLs and anchors matching the focus come first, deep URLs and busy hosts last
+int frontier_default_score(const frontier *f, const frontier_entry *e) {
+    (void)f;
+    int score = 128;
+
+    // Each doubling of the inlink count is worth as much as one level of depth
+    for (unsigned n = e->inlinks; n > 1; n >>= 1) score += 16;
+    score += 24 * (int)(e->anchor_hits < 4 ? e->anchor_hits : 4);
+    score -= 16 * e->depth;
+
+    // A host that used up its quota only gets what nothing else wants
+    if (e->host->fetched >= FRONTIER_HOST_QUOTA) score -= 96 + (int)(e->host->fetched - FRONTIER_HOST_QUOTA);
+
+    if (score < 0) return 0;
+    if (score >= FRONTIER_LEVELS) return FRONTIER_LEVELS - 1;
+    return score;
+}
+
+// Append an entry to the tail of its priority bucket
+static void bucket_insert(frontier *f, frontier_entry *e, int priority) {
+    e->priority = priority;
+    e->next = NULL;
+    e->prev = f->tail[priority];
+    if (e->prev) {
+        e->prev->next = e;
+    } else {
+        f->head[priority] = e;
+    }
+    f->tail[priority] = e;
+    f->occupied[priority / 64] |= 1ULL << (priority % 64);
+}
+
+// Unlink an entry from its priority bucket
+static void bucket_remove(frontier *f, frontier_entry *e) {
+    int priority = e->priority;
+    if (e->prev) {
+        e->prev->next = e->next;
+    } else {
+        f->head[priority] = e->next;
+    }
+    if (e->next) {
+        e->next->prev = e->prev;
+    } else {
+        f->tail[priority] = e->prev;
+    }
+    if (!f->head[priority]) f->occupied[priority / 64] &= ~(1ULL << (priority % 64));
+}
+
+// Highest non-empty bucket, or -1 when the frontier is empty
+static int top_bucket(frontier *f) {
+    for (int word = FRONTIER_LEVELS / 64 - 1; word >= 0; word--) {
+        if (f->occupied[word]) return word * 64 + 63 - __builtin_clzll(f->occupied[word]);
+    }
+    return -1;
+}
+
+// Find the slot of a URL: either the slot holding it or the empty slot where it belongs
+static uint32_t find_slot(frontier *f, const char *url, uint32_t hash) {
+    uint32_t i = hash & (f->slot_count - 1);
+    while (f->slots[i]) {
+        if (f->slots[i]->hash == hash && strcmp(f->slots[i]->url, url) == 0) break;
+        i = (i + 1) & (f->slot_count - 1);
+    }
+    return i;
+}
+
+// Resize the URL table to `slot_count` slots and reinsert every queued entry
+static void resize_slots(frontier *f, uint32_t slot_count) {
+    uint32_t old_count = f->slot_count;
+    frontier_entry **old = f->slots;
+
+    f->slot_count = slot_count;
+    f->slots = (frontier_entry **)calloc(f->slot_count, sizeof(frontier_entry *));
+    for (uint32_t i = 0; i < old_count; i++) {
+        if (!old[i]) continue;
+        uint32_t j = old[i]->hash & (f->slot_count - 1);
+        while (f->slots[j]) j = (j + 1) & (f->slot_count - 1);
+        f->slots[j] = old[i];
+    }
+    free(old);
+}
+
+// Remove an entry from the URL table, shifting later entries of its probe run back into the hole
+static void remove_slot(frontier *f, frontier_entry *e) {
+    uint32_t mask = f->slot_count - 1;
+    uint32_t hole = find_slot(f, e->url, e->hash);
+    f->slots[hole] = NULL;
+
+    for (uint32_t i = (hole + 1) & mask; f->slots[i]; i = (i + 1) & mask) {
+        uint32_t home = f->slots[i]->hash & mask;
+        // Move the entry unless its home slot lies cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            f->slots[hole] = f->slots[i];
+            f->slots[i] = NULL;
+            hole = i;
+        }
+    }
+}
+
+// Return the host record of a URL, creating it on first use
+static frontier_host *get_host(frontier *f, const char *url) {
+    size_t length = host_length(url);
+    uint32_t hash = frontier_hash(url, length);
+    frontier_host **bucket = &f->hosts[hash % FRONTIER_HOST_BUCKETS];
+
+    for (frontier_host *h = *bucket; h; h = h->next) {
+        if (h->hash == hash && strncmp(h->host, url, length) == 0 && h->host[length] == '\0') return h;
+    }
+
+    frontier_host *h = (frontier_host *)arena_alloc(&f->pool, sizeof(frontier_host));
+    h->host = arena_strndup(&f->pool, url, length);
+    h->hash = hash;
+    h->fetched = 0;
+    h->next = *bucket;
+    *bucket = h;
+    return h;
+}
+
+// Create an entry for a URL and put it in the URL table and its bucket
+static void insert_entry(frontier *f, const char *url, int depth, unsigned inlinks, unsigned anchor_hits) {
+    // Reuse a released entry if there is one, otherwise allocate one that spilling can give back
+    frontier_entry *e = f->free_entries;
+    if (e) {
+        f->free_entries = e->next;
+        f->free_count--;
+    } else {
+        e = (frontier_entry *)malloc(sizeof(frontier_entry));
+        f->entry_count++;
+    }
+
+    size_t length = strlen(url);
+    e->url = (char *)malloc(length + 1);
+    memcpy(e->url, url, length + 1);
+    f->url_bytes += length + 1;
+
+    e->hash = frontier_hash(url, length);
+    e->depth = depth;
+    e->inlinks = inlinks;
+    e->anchor_hits = anchor_hits;
+    e->host = get_host(f, url);
+
+    f->slots[find_slot(f, url, e->hash)] = e;
+    f->count++;
+    if (f->count * 2 > f->slot_count) resize_slots(f, f->slot_count * 2);
+
+    bucket_insert(f, e, f->score(f, e));
+}
+
+// Free an entry's URL and keep the entry for reuse, or free it once enough are kept
+static void drop_entry(frontier *f, frontier_entry *e) {
+    f->url_bytes -= strlen(e->url) + 1;
+    free(e->url);
+    if (f->free_count < FRONTIER_FREE_ENTRIES) {
+        e->next = f->free_entries;
+        f->free_entries = e;
+        f->free_count++;
+    } else {
+        free(e);
+        f->entry_count--;
+    }
+}
+
+// Spill band holding a priority
+static int priority_band(int priority) {
+    return priority * FRONTIER_SPILL_BANDS / FRONTIER_LEVELS;
+}
+
+// Path of the spill file of a band
+static void band_path(const frontier *f, int band, char *path, size_t size) {
+    snprintf(path, size, "%s.%d", f->spill_path, band);
+}
+
+// Open the spill file of every band; on failure spilling is disabled and everything stays in memory
+static int open_spill(frontier *f) {
+    char path[512];
+    for (int band = 0; band < FRONTIER_SPILL_BANDS; band++) {
+        band_path(f, band, path, sizeof(path));
+        f->bands[band].file = fopen(path, "w+b");
+        if (!f->bands[band].file) {
+            fprintf(stderr, "Cannot write frontier spill file %s\n", path);
+            while (band-- > 0) {
+                fclose(f->bands[band].file);
+                f->bands[band].file = NULL;
+                band_path(f, band, path, sizeof(path));
+                remove(path);
+            }
+            free(f->spill_path);
+            f->spill_path = NULL;  // Keep everything in memory from now on
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Append a URL to the spill file of its priority band; returns 0 if spilling is disabled or the file cannot be written
+static int spill_write(frontier *f, int priority, const char *url, int depth, unsigned inlinks, unsigned anchor_hits) {
+    if (!f->spill_path) return 0;
+    if (!f->bands[0].file && !open_spill(f)) return 0;
+
+    // Fixed header of depth, inlinks, anchor hits and URL length, then the URL
+    frontier_band *band = &f->bands[priority_band(priority)];
+    uint32_t length = (uint32_t)strlen(url);
+    uint32_t header[4] = { (uint32_t)depth, inlinks, anchor_hits, length };
+    fseek(band->file, 0, SEEK_END);
+    if (fwrite(header, sizeof(header), 1, band->file) != 1 || fwrite(url, 1, length, band->file) != length) {
+        fprintf(stderr, "Cannot write frontier spill file %s.%d\n", f->spill_path, priority_band(priority));
+        return 0;
+    }
+    band->count++;
+    f->spilled++;
+    return 1;
+}
+
+// Highest band with spilled URLs, or -1 when nothing is spilled
+static int top_band(const frontier *f) {
+    for (int band = FRONTIER_SPILL_BANDS - 1; band >= 0; band--) {
+        if (f->bands[band].count > 0) return band;
+    }
+    return -1;
+}
+
+// Read a batch of spilled URLs of one band back into memory; returns the number loaded
+static unsigned reload_spilled(frontier *f, int index) {
+    frontier_band *band = &f->bands[index];
+    unsigned loaded = 0;
+    size_t capacity = 0;
+    char *url = NULL;
+
+    fseek(band->file, band->read, SEEK_SET);
+    while (band->count > 0 && loaded < FRONTIER_RELOAD_BATCH) {
+        uint32_t header[4];
+        if (fread(header, sizeof(header), 1, band->file) != 1) break;
+        if (header[3] + 1 > capacity) {
+            capacity = header[3] + 1;
+            url = (char *)realloc(url, capacity);
+        }
+        if (fread(url, 1, header[3], band->file) != header[3]) break;
+        url[header[3]] = '\0';
+
+        band->count--;
+        f->spilled--;
+        if (f->slots[find_slot(f, url, frontier_hash(url, header[3]))]) continue;
+        insert_entry(f, url, (int)header[0], header[1], header[2]);
+        loaded++;
+    }
+    free(url);
+
+    band->read = ftell(band->file);
+    if (band->count == 0 || feof(band->file) || ferror(band->file)) {
+        // Everything was read back (or the file is unreadable): start the file over
+        f->spilled -= band->count;
+        band->count = 0;
+        fflush(band->file);
+        if (ftruncate(fileno(band->file), 0) != 0) fprintf(stderr, "Cannot truncate frontier spill file %s.%d\n", f->spill_path, index);
+        clearerr(band->file);
+        band->read = 0;
+    }
+    return loaded;
+}
+
+// Queue a URL found at `depth`; a URL that is already queued gains an inlink instead
+int frontier_push(frontier *f, const char *url, int depth, unsigned anchor_hits) {
+    if (depth > f->max_depth) return 0;  // Never queue what would be skipped anyway
+    if (frontier_add_inlink(f, url, depth, anchor_hits)) return 1;
+
+    // Under memory pressure new URLs wait on disk, in the band of the priority they would get
+    if (f->throttled && f->spill_path) {
+        frontier_entry probe = { NULL, 0, depth, 1, anchor_hits, get_host(f, url), 0, NULL, NULL };
+        if (spill_write(f, f->score(f, &probe), url, depth, 1, anchor_hits)) return 1;
+    }
+
+    insert_entry(f, url, depth, 1, anchor_hits);
+    return 1;
+}
+
+// Allow low-priority URLs to be moved to a file under memory pressure
+void frontier_enable_spill(frontier *f, const char *path) {
+    free(f->spill_path);
+    f->spill_path = strdup(path);
+}
+
+// Move up to `count` of the lowest-priority URLs to the spill files, newest first within a bucket
+unsigned frontier_spill(frontier *f, unsigned count) {
+    unsigned moved = 0;
+    int failed = 0;
+    for (int priority = 0; priority < FRONTIER_LEVELS && moved < count && !failed; priority++) {
+        while (f->tail[priority] && moved < count) {
+            frontier_entry *e = f->tail[priority];
+            if (!spill_write(f, priority, e->url, e->depth, e->inlinks, e->anchor_hits)) {
+                failed = 1;
+                break;
+            }
+
+            bucket_remove(f, e);
+            remove_slot(f, e);
+            f->count--;
+            drop_entry(f, e);
+            moved++;
+        }
+    }
+
+    // Give back the URL table once it is mostly empty, keeping room to grow again
+    uint32_t slot_count = f->slot_count;
+    while (slot_count > FRONTIER_MIN_SLOTS && f->count * 8 < slot_count) slot_count /= 2;
+    if (slot_count != f->slot_count) resize_slots(f, slot_count);
+    return moved;
+}
+
+// Bytes held by the frontier
+size_t frontier_memory(const frontier *f) {
+    return f->pool.reserved + f->url_bytes + f->entry_count * sizeof(frontier_entry) + f->slot_count * sizeof(frontier_entry *);
+}
+
+// Bytes that spilling every queued URL would give back: the URLs, their entries and most of the URL table
+size_t frontier_spillable(const frontier *f) {
+    return f->url_bytes + f->count * (sizeof(frontier_entry) + 2 * sizeof(frontier_entry *));
+}
+
+// Record another link to a queued URL found at `depth` and move it to its new bucket
+int frontier_add_inlink(frontier *f, const char *url, int depth, unsigned anchor_hits) {
+    frontier_entry *e = f->slots[find_slot(f, url, frontier_hash(url, strlen(url)))];
+    if (!e) return 0;
+
+    if (depth < e->depth) e->depth = depth;  // Keep the shortest path from the seed
+    e->inlinks++;
+    e->anchor_hits += anchor_hits;
+    int priority = f->score(f, e);
+    if (priority != e->priority) {
+        bucket_remove(f, e);
+        bucket_insert(f, e, priority);
+    }
+    return 1;
+}
+
+// Remove and return the highest-priority entry
+frontier_entry *frontier_pop(frontier *f) {
+    int promoted = 0;
+    for (;;) {
+        int priority = top_bucket(f);
+        int band = top_band(f);
+        if (priority < 0) {
+            if (band < 0) return NULL;
+            reload_spilled(f, band);  // Memory ran dry: bring back the best spilled URLs first
+            continue;
+        }
+
+        // Spilled URLs that outrank everything in memory come back once the pressure is gone
+        if (!f->throttled && !promoted && band > priority_band(priority)) {
+            reload_spilled(f, band);
+            promoted = 1;
+            continue;
+        }
+
+        frontier_entry *e = f->head[priority];
+        bucket_remove(f, e);
+
+        // Host counts only grow while an entry waits, so a stale priority can only be too high: re-score lazily
+        int current = f->score(f, e);
+        if (current < priority) {
+            bucket_insert(f, e, current);
+            continue;
+        }
+
+        remove_slot(f, e);
+        f->count--;
+        e->host->fetched++;
+        return e;
+    }
+}
+
+// Return a popped entry so its memory is reused by the next push
+void frontier_release(frontier *f, frontier_entry *e) {
+    drop_entry(f, e);
+}
+
+// Free every entry, URL and host held by the frontier and remove the spill files
+void frontier_free(frontier *f) {
+    for (int priority = 0; priority < FRONTIER_LEVELS; priority++) {
+        frontier_entry *e = f->head[priority];
+        while (e) {
+            frontier_entry *next = e->next;
+            free(e->url);
+            free(e);
+            e = next;
+        }
+    }
+    while (f->free_entries) {
+        frontier_entry *next = f->free_entries->next;
+        free(f->free_entries);
+        f->free_entries = next;
+    }
+    for (int band = 0; band < FRONTIER_SPILL_BANDS; band++) {
+        if (!f->bands[band].file) continue;
+        char path[512];
+        band_path(f, band, path, sizeof(path));
+        fclose(f->bands[band].file);
+        remove(path);
+    }
+    free(f->spill_path);
+    free(f->slots);
+    arena_free(&f->pool);
+    memset(f, 0, sizeof(*f));
+}
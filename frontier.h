@@ -0,0 +1,90 @@
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "arena.h"
+#include "hashmap.h"
+
+#define FRONTIER_LEVELS 256         // Priority buckets; a larger priority is fetched first
+#define FRONTIER_HOST_QUOTA 32      // Pages fetched from one host before its remaining URLs are demoted
+#define FRONTIER_HOST_BUCKETS 1024  // Buckets of the host table
+#define FRONTIER_RELOAD_BATCH 4096  // Spilled URLs read back at once when the in-memory frontier runs dry
+#define FRONTIER_SPILL_BANDS 8      // Spill files, one per band of FRONTIER_LEVELS / FRONTIER_SPILL_BANDS priorities
+#define FRONTIER_MIN_SLOTS 1024     // Smallest URL table; spilling shrinks a larger one back towards this
+#define FRONTIER_FREE_ENTRIES 1024  // Released entries kept for reuse; any more are freed
+
+// Pages fetched from one host, used by the host quota
+typedef struct frontier_host {
+    char *host;                  // "scheme://host"
+    uint32_t hash;               // Hash of the host
+    unsigned fetched;            // Pages popped for this host
+    struct frontier_host *next;  // Next host in the same bucket
+} frontier_host;
+
+// A URL waiting in the frontier
+typedef struct frontier_entry {
+    char *url;                   // URL to fetch, heap-allocated so spilling gives the memory back
+    uint32_t hash;               // Hash of the URL
+    int depth;                   // Link distance from the seed
+    unsigned inlinks;            // Links to the URL seen while it was queued
+    unsigned anchor_hits;        // Focus terms found in the anchor text of those links
+    frontier_host *host;         // Host of the URL
+    int priority;                // Bucket the entry is in
+    struct frontier_entry *prev; // Neighbours within the bucket, FIFO among equal priorities
+    struct frontier_entry *next;
+} frontier_entry;
+
+// Spilled URLs of one priority band, read back in the order they were written
+typedef struct frontier_band {
+    FILE *file;                  // Open spill file, NULL until spilling starts
+    long read;                   // Offset of the first spilled URL not yet read back
+    unsigned count;              // URLs waiting in the file
+} frontier_band;
+
+struct frontier;
+
+// Scoring policy: maps an entry to a priority in [0, FRONTIER_LEVELS)
+typedef int (*frontier_score_fn)(const struct frontier *f, const frontier_entry *e);
+
+// Bucketed priority queue of URLs with O(1) push, pop and priority update
+typedef struct frontier {
+    frontier_entry *head[FRONTIER_LEVELS];       // First entry of each bucket
+    frontier_entry *tail[FRONTIER_LEVELS];       // Last entry of each bucket
+    uint64_t occupied[FRONTIER_LEVELS / 64];     // Bit set of the non-empty buckets
+    unsigned count;                              // Entries queued
+
+    frontier_entry **slots;                      // Open-addressing table of queued entries by URL
+    uint32_t slot_count;                         // Size of `slots`, a power of two
+
+    frontier_host *hosts[FRONTIER_HOST_BUCKETS]; // Pages fetched per host
+    HashMap focus;                               // Case-folded terms that make an anchor relevant
+    int max_depth;                               // Links deeper than this are never queued
+    frontier_score_fn score;                     // Scoring policy
+    frontier_entry *free_entries;                // Released entries kept for reuse
+    unsigned free_count;                         // Entries in `free_entries`
+    unsigned entry_count;                        // Entries allocated: queued, popped and kept for reuse
+    arena pool;                                  // Hosts and focus terms
+    size_t url_bytes;                            // Heap bytes of the queued URLs, released when they are popped or spilled
+
+    char *spill_path;                            // Prefix of the spill files, NULL if spilling is disabled
+    frontier_band bands[FRONTIER_SPILL_BANDS];   // Spilled URLs by priority band
+    unsigned spilled;                            // URLs waiting in all spill files
+    int throttled;                               // While set, new URLs go straight to the spill file
+} frontier;
+
+void frontier_init(frontier *f, int max_depth, frontier_score_fn score); // Create an empty frontier (score NULL selects frontier_default_score)
+void frontier_add_focus(frontier *f, const char *text, size_t length); // Add the tokens of a text to the focus terms
+unsigned frontier_anchor_hits(frontier *f, const char *text, size_t length); // Count focus terms in an anchor text
+int frontier_push(frontier *f, const char *url, int depth, unsigned anchor_hits); // Queue a URL; returns 0 if it is beyond max_depth
+int frontier_add_inlink(frontier *f, const char *url, int depth, unsigned anchor_hits); // Record another link to a queued URL found at `depth`, keeping its smallest depth, and re-score it; returns 0 if it is not queued
+frontier_entry *frontier_pop(frontier *f); // Remove and return the highest-priority entry, or NULL when empty
+void frontier_release(frontier *f, frontier_entry *e); // Return a popped entry for reuse
+void frontier_free(frontier *f); // Free every entry, URL and host and remove the spill files
+void frontier_enable_spill(frontier *f, const char *path); // Allow low-priority URLs to be moved to files named `path`.<band> under memory pressure
+unsigned frontier_spill(frontier *f, unsigned count); // Move up to `count` of the lowest-priority URLs to the spill files; returns how many moved
+size_t frontier_memory(const frontier *f); // Bytes held by the frontier
+size_t frontier_spillable(const frontier *f); // Bytes that spilling every queued URL would give back
+int frontier_default_score(const frontier *f, const frontier_entry *e); // Inlinks and anchor matches raise the priority; depth and the host quota lower it
+
+#endif
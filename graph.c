@@ -0,0 +1,451 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "graph.h"
+
+#define GRAPH_IO_BUFFER (1 << 20)  // stdio buffer for run and CSR files
+
+// Cursor over one sorted run during the merge
+typedef struct run_reader {
+    FILE *file;      // Open run file
+    uint64_t key;    // Current edge
+    int valid;       // A current edge is loaded
+} run_reader;
+
+// Work shared by the PageRank threads
+typedef struct pagerank_job {
+    link_graph *g;
+    int threads;               // Number of workers
+    int max_iterations;        // Iteration limit
+    int iterations;            // Iterations run
+    float *next;               // Ranks being computed
+    float *contrib;            // rank / out-degree of every node for the current iteration
+    double *dangling;          // Per-thread rank of nodes without out-links
+    double *delta;             // Per-thread L1 change of the iteration
+    uint32_t *bounds;          // Node range of each thread: [bounds[t], bounds[t + 1])
+    int done;                  // Set by thread 0 once converged
+    pthread_barrier_t barrier; // Separates the phases of an iteration
+} pagerank_job;
+
+// Argument of a PageRank worker
+typedef struct pagerank_worker {
+    pagerank_job *job;
+    int id;
+} pagerank_worker;
+
+// 32-bit FNV-1a hash of a URL
+static uint32_t url_hash(const char *url) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)url; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Path of run number `n`
+static void run_path(link_graph *g, int n, char *path, size_t size) {
+    snprintf(path, size, "%s/run-%05d.edges", g->dir, n);
+}
+
+// Path of the CSR sources file
+static void csr_path(link_graph *g, char *path, size_t size) {
+    snprintf(path, size, "%s/inlinks.csr", g->dir);
+}
+
+// Create an empty graph spilling into `dir`
+void graph_init(link_graph *g, const char *dir, size_t edge_budget) {
+    memset(g, 0, sizeof(*g));
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create graph directory %s\n", dir);
+    }
+
+    g->dir = strdup(dir);
+    g->slot_count = 1024;
+    g->slots = (uint32_t *)calloc(g->slot_count, sizeof(uint32_t));
+    arena_init(&g->url_pool, 0);
+
+    g->edge_budget = edge_budget ? edge_budget : GRAPH_EDGE_BUFFER;
+    g->edges = (uint64_t *)malloc(g->edge_budget * sizeof(uint64_t));
+}
+
+// Double the open-addressing table and reinsert every ID
+static void grow_slots(link_graph *g) {
+    uint32_t slot_count = g->slot_count * 2;
+    uint32_t *slots = (uint32_t *)calloc(slot_count, sizeof(uint32_t));
+
+    for (uint32_t id = 0; id < g->url_count; id++) {
+        uint32_t i = g->hashes[id] & (slot_count - 1);
+        while (slots[i]) i = (i + 1) & (slot_count - 1);
+        slots[i] = id + 1;
+    }
+
+    free(g->slots);
+    g->slots = slots;
+    g->slot_count = slot_count;
+}
+
+// Find the slot of a URL: either the slot holding it or the empty slot where it belongs
+static uint32_t find_slot(link_graph *g, const char *url, uint32_t hash) {
+    uint32_t i = hash & (g->slot_count - 1);
+    while (g->slots[i]) {
+        uint32_t id = g->slots[i] - 1;
+        if (g->hashes[id] == hash && strcmp(g->urls[id], url) == 0) break;
+        i = (i + 1) & (g->slot_count - 1);
+    }
+    return i;
+}
+
+// Look up a URL without assigning an ID; returns 0 if it is unknown
+int graph_find(link_graph *g, const char *url, uint32_t *id) {
+    uint32_t slot = find_slot(g, url, url_hash(url));
+    if (!g->slots[slot]) return 0;
+    *id = g->slots[slot] - 1;
+    return 1;
+}
+
+// Return the ID of a URL, assigning the next free one if it is new
+uint32_t graph_url_id(link_graph *g, const char *url) {
+    uint32_t hash = url_hash(url);
+    uint32_t slot = find_slot(g, url, hash);
+    if (g->slots[slot]) return g->slots[slot] - 1;
+
+    if (g->url_count == g->url_capacity) {
+        g->url_capacity = g->url_capacity ? g->url_capacity * 2 : 1024;
+        g->urls = (char **)realloc(g->urls, g->url_capacity * sizeof(char *));
+        g->hashes = (uint32_t *)realloc(g->hashes, g->url_capacity * sizeof(uint32_t));
+    }
+
+    uint32_t id = g->url_count++;
+    g->urls[id] = arena_strdup(&g->url_pool, url);
+    g->hashes[id] = hash;
+    g->slots[slot] = id + 1;
+    if (id >= g->node_count) g->node_count = id + 1;
+
+    // Keep the table at most half full
+    if (g->url_count * 2 > g->slot_count) grow_slots(g);
+    return id;
+}
+
+// Sort 64-bit keys with four 16-bit LSD radix passes, skipping digits that are the same for every key
+static void radix_sort(uint64_t *keys, size_t n) {
+    uint64_t *tmp = (uint64_t *)malloc(n * sizeof(uint64_t));
+    size_t *count = (size_t *)malloc(65536 * sizeof(size_t));
+    uint64_t *from = keys, *to = tmp;
+
+    for (int shift = 0; shift < 64; shift += 16) {
+        memset(count, 0, 65536 * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) count[(from[i] >> shift) & 0xFFFF]++;
+        if (count[(from[0] >> shift) & 0xFFFF] == n) continue;
+
+        size_t sum = 0;
+        for (size_t d = 0; d < 65536; d++) {
+            size_t c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) to[count[(from[i] >> shift) & 0xFFFF]++] = from[i];
+
+        uint64_t *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != keys) memcpy(keys, from, n * sizeof(uint64_t));
+    free(count);
+    free(tmp);
+}
+
+// Sort, deduplicate and write the edge buffer as a new run
+static void spill_edges(link_graph *g) {
+    if (g->edge_count == 0) return;
+
+    radix_sort(g->edges, g->edge_count);
+    size_t unique = 1;
+    for (size_t i = 1; i < g->edge_count; i++) {
+        if (g->edges[i] != g->edges[unique - 1]) g->edges[unique++] = g->edges[i];
+    }
+
+    char path[512];
+    run_path(g, g->run_count, path, sizeof(path));
+    FILE *file = fopen(path, "wb");
+    int written = file && fwrite(g->edges, sizeof(uint64_t), unique, file) == unique;
+    if (file && fclose(file) != 0) written = 0;
+    g->edge_count = 0;  // The buffer is free again whether or not the run reached the disk
+    if (!written) {
+        // Drop the run rather than overrun the buffer; the graph misses these edges
+        fprintf(stderr, "Cannot write graph run %s, dropping %zu edges\n", path, unique);
+        if (file) remove(path);
+        return;
+    }
+    g->run_count++;
+}
+
+// Record a link from `source` to `target`; self-links are ignored
+void graph_add_edge(link_graph *g, uint32_t source, uint32_t target) {
+    if (source >= g->node_count) g->node_count = source + 1;
+    if (target >= g->node_count) g->node_count = target + 1;
+    if (source == target) return;  // A page linking to itself would only inflate its own out-degree
+
+    g->edges[g->edge_count++] = ((uint64_t)target << 32) | source;
+    if (g->edge_count == g->edge_budget) spill_edges(g);
+}
+
+// Load the next edge of a run
+static void run_next(run_reader *r) {
+    r->valid = fread(&r->key, sizeof(uint64_t), 1, r->file) == 1;
+}
+
+// Restore the min-heap property of the run readers below position i
+static void heap_down(run_reader **heap, int size, int i) {
+    for (;;) {
+        int smallest = i, left = 2 * i + 1, right = 2 * i + 2;
+        if (left < size && heap[left]->key < heap[smallest]->key) smallest = left;
+        if (right < size && heap[right]->key < heap[smallest]->key) smallest = right;
+        if (smallest == i) return;
+
+        run_reader *swap = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+// Merge the spilled runs into the CSR: in-link sources go to a file that is then memory-mapped
+void graph_build(link_graph *g) {
+    spill_edges(g);
+
+    uint32_t n = g->node_count;
+    g->offsets = (uint64_t *)calloc((size_t)n + 1, sizeof(uint64_t));
+    g->out_degree = (uint32_t *)calloc(n ? n : 1, sizeof(uint32_t));
+    g->csr_edges = 0;
+
+    char path[512];
+    csr_path(g, path, sizeof(path));
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Cannot write graph file %s\n", path);
+        return;
+    }
+    setvbuf(out, NULL, _IOFBF, GRAPH_IO_BUFFER);
+
+    // k-way merge of the runs, which are each sorted by (target, source)
+    run_reader *readers = (run_reader *)calloc(g->run_count ? g->run_count : 1, sizeof(run_reader));
+    run_reader **heap = (run_reader **)malloc((g->run_count ? g->run_count : 1) * sizeof(run_reader *));
+    int heap_size = 0;
+    for (int i = 0; i < g->run_count; i++) {
+        run_path(g, i, path, sizeof(path));
+        readers[i].file = fopen(path, "rb");
+        if (!readers[i].file) continue;
+        setvbuf(readers[i].file, NULL, _IOFBF, GRAPH_IO_BUFFER);
+        run_next(&readers[i]);
+        if (readers[i].valid) heap[heap_size++] = &readers[i];
+    }
+    for (int i = heap_size / 2 - 1; i >= 0; i--) heap_down(heap, heap_size, i);
+
+    uint64_t previous = 0;
+    while (heap_size > 0) {
+        run_reader *r = heap[0];
+        uint64_t key = r->key;
+
+        if (g->csr_edges == 0 || key != previous) {
+            uint32_t source = (uint32_t)key, target = (uint32_t)(key >> 32);
+            fwrite(&source, sizeof(uint32_t), 1, out);
+            g->offsets[target + 1]++;
+            g->out_degree[source]++;
+            g->csr_edges++;
+            previous = key;
+        }
+
+        run_next(r);
+        if (!r->valid) heap[0] = heap[--heap_size];
+        heap_down(heap, heap_size, 0);
+    }
+    fclose(out);
+
+    for (int i = 0; i < g->run_count; i++) {
+        if (readers[i].file) fclose(readers[i].file);
+        run_path(g, i, path, sizeof(path));
+        remove(path);
+    }
+    free(readers);
+    free(heap);
+    g->run_count = 0;
+
+    // Counts to row starts
+    for (uint32_t v = 0; v < n; v++) g->offsets[v + 1] += g->offsets[v];
+
+    // Map the sources instead of reading them so the graph may exceed memory
+    if (g->csr_edges > 0) {
+        csr_path(g, path, sizeof(path));
+        int fd = open(path, O_RDONLY);
+        g->sources_bytes = g->csr_edges * sizeof(uint32_t);
+        void *map = fd >= 0 ? mmap(NULL, g->sources_bytes, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (fd >= 0) close(fd);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "Cannot map graph file %s\n", path);
+            g->sources_bytes = 0;
+        } else {
+            madvise(map, g->sources_bytes, MADV_SEQUENTIAL);  // Every iteration streams the file front to back
+            g->sources = (uint32_t *)map;
+        }
+    }
+}
+
+// PageRank worker: each thread owns a range of nodes balanced by in-link count
+static void *pagerank_thread(void *arg) {
+    pagerank_worker *worker = (pagerank_worker *)arg;
+    pagerank_job *job = worker->job;
+    link_graph *g = job->g;
+    int t = worker->id;
+    uint32_t lo = job->bounds[t], hi = job->bounds[t + 1];
+    double n = (double)g->node_count;
+
+    for (;;) {
+        // Phase 1: spread each node's rank over its out-links and collect dangling rank
+        double dangling = 0;
+        for (uint32_t u = lo; u < hi; u++) {
+            if (g->out_degree[u]) {
+                job->contrib[u] = g->rank[u] / g->out_degree[u];
+            } else {
+                job->contrib[u] = 0;
+                dangling += g->rank[u];
+            }
+        }
+        job->dangling[t] = dangling;
+        pthread_barrier_wait(&job->barrier);
+
+        // Phase 2: pull contributions along in-links
+        double total_dangling = 0;
+        for (int i = 0; i < job->threads; i++) total_dangling += job->dangling[i];
+        double base = (1.0 - GRAPH_DAMPING) / n + GRAPH_DAMPING * total_dangling / n;
+
+        double delta = 0;
+        for (uint32_t v = lo; v < hi; v++) {
+            double sum = 0;
+            for (uint64_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) sum += job->contrib[g->sources[e]];
+            float value = (float)(base + GRAPH_DAMPING * sum);
+            delta += value > g->rank[v] ? value - g->rank[v] : g->rank[v] - value;
+            job->next[v] = value;
+        }
+        job->delta[t] = delta;
+        pthread_barrier_wait(&job->barrier);
+
+        // Thread 0 decides whether to stop and swaps the rank arrays
+        if (t == 0) {
+            double total_delta = 0;
+            for (int i = 0; i < job->threads; i++) total_delta += job->delta[i];
+            float *swap = g->rank;
+            g->rank = job->next;
+            job->next = swap;
+            job->iterations++;
+            job->done = total_delta < GRAPH_TOLERANCE || job->iterations >= job->max_iterations;
+        }
+        pthread_barrier_wait(&job->barrier);
+        if (job->done) break;
+    }
+    return NULL;
+}
+
+// Compute PageRank over the CSR with `threads` workers; returns the number of iterations run
+int graph_pagerank(link_graph *g, int max_iterations, int threads) {
+    uint32_t n = g->node_count;
+    if (n == 0 || !g->offsets) return 0;
+    if (g->csr_edges > 0 && !g->sources) return 0;
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if ((uint32_t)threads > n) threads = (int)n;
+
+    pagerank_job job;
+    memset(&job, 0, sizeof(job));
+    job.g = g;
+    job.threads = threads;
+    job.max_iterations = max_iterations;
+    job.next = (float *)malloc(n * sizeof(float));
+    job.contrib = (float *)malloc(n * sizeof(float));
+    job.dangling = (double *)calloc(threads, sizeof(double));
+    job.delta = (double *)calloc(threads, sizeof(double));
+    job.bounds = (uint32_t *)malloc((threads + 1) * sizeof(uint32_t));
+
+    free(g->rank);
+    g->rank = (float *)malloc(n * sizeof(float));
+    for (uint32_t v = 0; v < n; v++) g->rank[v] = 1.0f / n;
+
+    // Split the nodes so every thread pulls about the same number of in-links
+    uint64_t work = g->csr_edges + n;
+    job.bounds[0] = 0;
+    uint32_t v = 0;
+    for (int t = 1; t < threads; t++) {
+        uint64_t goal = work * t / threads;
+        while (v < n && g->offsets[v] + v < goal) v++;
+        job.bounds[t] = v;
+    }
+    job.bounds[threads] = n;
+
+    pthread_barrier_init(&job.barrier, NULL, threads);
+    pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    pagerank_worker *workers = (pagerank_worker *)malloc(threads * sizeof(pagerank_worker));
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+        workers[t].id = t;
+        if (t > 0) pthread_create(&tids[t], NULL, pagerank_thread, &workers[t]);
+    }
+    pagerank_thread(&workers[0]);  // The calling thread is worker 0
+    for (int t = 1; t < threads; t++) pthread_join(tids[t], NULL);
+    pthread_barrier_destroy(&job.barrier);
+
+    free(tids);
+    free(workers);
+    free(job.next);
+    free(job.contrib);
+    free(job.dangling);
+    free(job.delta);
+    free(job.bounds);
+    return job.iterations;
+}
+
+// PageRank of a URL scaled so the average page scores 1, or 0 if it is unknown or ranks were not computed
+double graph_score(link_graph *g, const char *url) {
+    uint32_t id;
+    if (!g->rank || !graph_find(g, url, &id)) return 0;
+    return (double)g->rank[id] * g->node_count;
+}
+
+// Bytes held in memory by the graph; the mapped in-link sources live in the page cache and are not counted
+size_t graph_memory(const link_graph *g) {
+    size_t bytes = (size_t)g->slot_count * sizeof(uint32_t) + g->url_pool.reserved;
+    bytes += (size_t)g->url_capacity * (sizeof(char *) + sizeof(uint32_t));
+    bytes += g->edge_budget * sizeof(uint64_t);
+    if (g->offsets) bytes += ((size_t)g->node_count + 1) * sizeof(uint64_t) + (size_t)g->node_count * sizeof(uint32_t);
+    if (g->rank) bytes += (size_t)g->node_count * sizeof(float);
+    return bytes;
+}
+
+// Release the graph and remove its temporary files
+void graph_free(link_graph *g) {
+    char path[512];
+    for (int i = 0; i < g->run_count; i++) {
+        run_path(g, i, path, sizeof(path));
+        remove(path);
+    }
+    if (g->sources) munmap(g->sources, g->sources_bytes);
+    csr_path(g, path, sizeof(path));
+    remove(path);
+
+    free(g->urls);
+    free(g->hashes);
+    free(g->slots);
+    arena_free(&g->url_pool);
+    free(g->edges);
+    free(g->offsets);
+    free(g->out_degree);
+    free(g->rank);
+    free(g->dir);
+}
@@ -0,0 +1,48 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define GRAPH_EDGE_BUFFER (16 * 1024 * 1024)  // Edges buffered in memory before a sorted run is spilled to disk
+#define GRAPH_DAMPING 0.85                    // PageRank damping factor
+#define GRAPH_TOLERANCE 1e-6                  // PageRank stops once the L1 change of an iteration drops below this
+
+// Link graph keyed by URL ID; built as compressed sparse rows of in-links for pull-based PageRank
+typedef struct link_graph {
+    char *dir;                 // Directory holding sorted edge runs and the CSR file
+
+    char **urls;               // URL of each ID
+    uint32_t *hashes;          // Hash of each URL, compared before the string
+    uint32_t url_count;        // IDs assigned to URLs
+    uint32_t url_capacity;     // Slots allocated in `urls` and `hashes`
+    uint32_t *slots;           // Open-addressing table of ID + 1 (0 marks an empty slot)
+    uint32_t slot_count;       // Size of `slots`, a power of two
+    arena url_pool;            // Storage for the URL strings
+
+    uint64_t *edges;           // Buffered edges as (target << 32 | source)
+    size_t edge_count;         // Edges in the buffer
+    size_t edge_budget;        // Buffer capacity
+    int run_count;             // Sorted runs spilled to disk
+    uint32_t node_count;       // One more than the largest ID seen in an edge or URL
+
+    uint64_t *offsets;         // CSR row starts: in-links of node v are sources[offsets[v]..offsets[v + 1])
+    uint32_t *sources;         // Source of every in-link, memory-mapped from the CSR file
+    size_t sources_bytes;      // Size of the mapping
+    uint32_t *out_degree;      // Distinct out-links of each node
+    uint64_t csr_edges;        // Distinct edges in the CSR
+    float *rank;               // PageRank of each node after graph_pagerank, NULL before
+} link_graph;
+
+void graph_init(link_graph *g, const char *dir, size_t edge_budget); // Create an empty graph spilling into `dir` (budget 0 selects GRAPH_EDGE_BUFFER)
+uint32_t graph_url_id(link_graph *g, const char *url); // Return the ID of a URL, assigning the next free one if it is new
+int graph_find(link_graph *g, const char *url, uint32_t *id); // Look up a URL without assigning an ID; returns 0 if it is unknown
+void graph_add_edge(link_graph *g, uint32_t source, uint32_t target); // Record a link; self-links are ignored and duplicates are removed when the graph is built
+void graph_build(link_graph *g); // Merge the spilled runs into the CSR, deduplicating edges
+int graph_pagerank(link_graph *g, int max_iterations, int threads); // Compute PageRank with `threads` workers (0 uses every CPU); returns the iterations run
+size_t graph_memory(const link_graph *g); // Bytes held in memory by the graph, not counting the mapped CSR file
+double graph_score(link_graph *g, const char *url); // PageRank of a URL scaled so the average page scores 1, or 0 if unknown
+void graph_free(link_graph *g); // Release the graph and remove its temporary files
+
+#endif
@@ -21,13 +21,26 @@ void init_hashmap(HashMap *hashmap) {
     for (int i = 0; i < TABLE_SIZE; i++) {
         hashmap->table[i] = NULL; // Initialize each bucket to NULL
     }
+    hashmap->pool = NULL; // Allocate nodes from the heap
+}
+
+// Initialize a hash map whose nodes and strings live in an arena and are released with it
+void init_hashmap_arena(HashMap *hashmap, arena *pool) {
+    init_hashmap(hashmap);
+    hashmap->pool = pool;
 }
 
 // Insert a URL into the hash map
 void insert_url(HashMap *hashmap, const char *url) {
     unsigned long index = hash_function(url); // Get the hash index for the URL
-    Node *new_node = (Node *)malloc(sizeof(Node)); // Allocate memory for a new node
-    new_node->url = strdup(url);  // Duplicate the URL string and store it in the node
+    Node *new_node;
+    if (hashmap->pool) {
+        new_node = (Node *)arena_alloc(hashmap->pool, sizeof(Node)); // Bump-allocate the node from the arena
+        new_node->url = arena_strdup(hashmap->pool, url);  // Copy the URL string into the arena
+    } else {
+        new_node = (Node *)malloc(sizeof(Node)); // Allocate memory for a new node
+        new_node->url = strdup(url);  // Duplicate the URL string and store it in the node
+    }
     new_node->next = hashmap->table[index];  // Point the new node to the current head of the list
     hashmap->table[index] = new_node;  // Insert the new node at the head of the list
 }
@@ -49,6 +62,12 @@ int search_url(HashMap *hashmap, const char *url) {
 
 // Free the memory allocated for the hash map
 void free_hashmap(HashMap *hashmap) {
+    // Nodes allocated from an arena are released together with the arena
+    if (hashmap->pool) {
+        init_hashmap_arena(hashmap, hashmap->pool);
+        return;
+    }
+
     // Iterate through each bucket in the hash table
     for (int i = 0; i < TABLE_SIZE; i++) {
         Node *current = hashmap->table[i]; // Get the head of the linked list
@@ -58,6 +77,7 @@ void free_hashmap(HashMap *hashmap) {
             free(temp->url);  // Free the memory allocated for the duplicated URL string
             free(temp);  // Free the memory allocated for the node
         }
+        hashmap->table[i] = NULL;
     }
 }
 
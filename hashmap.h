@@ -1,5 +1,9 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
 #include <stdlib.h>
 #include <string.h>
+#include "arena.h"
 
 #define TABLE_SIZE 100  // Define the size of the hash table; adjust based on expected data size
 
@@ -12,11 +16,14 @@ typedef struct Node {
 // Hashmap structure containing the hash table
 typedef struct HashMap {
     Node *table[TABLE_SIZE];  // Array of pointers to `Node`, serving as the hash table
+    arena *pool;              // Arena owning the nodes and strings, or NULL to use the heap
 } HashMap;
 
 unsigned long hash_function(const char *url); // Function to compute a hash value for a given URL
 void init_hashmap(HashMap *hashmap); // Function to initialize the hash map by setting all buckets to NULL
+void init_hashmap_arena(HashMap *hashmap, arena *pool); // Function to initialize a hash map whose nodes are allocated from an arena
 void insert_url(HashMap *hashmap, const char *url); // Function to insert a URL into the hash map
 int search_url(HashMap *hashmap, const char *url); // Function to search for a URL in the hash map, returning 1 if found and 0 otherwise
 void free_hashmap(HashMap *hashmap); // Function to free all memory allocated for the hash map
 
+#endif
@@ -0,0 +1,654 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "index.h"
+#include "tokenizer.h"
+
+#define SEGMENT_MAGIC "SEG1"           // First bytes of every segment file
+#define SEGMENT_IO_BUFFER (1 << 20)    // stdio buffer used for segment writes
+#define SEGMENT_READ_BUFFER (64 * 1024) // stdio buffer of each segment read during a merge
+#define MERGE_FANIN 64                 // Segments merged in one pass, bounding open files and buffers
+#define MAX_QUERY_TERMS 32             // Terms considered in a phrase or proximity query
+
+// Per-document state of a term while the document is being added
+typedef struct doc_term {
+    posting_list *list;        // Postings of the term
+    unsigned *positions;       // Positions of the term in the document
+    unsigned count;            // Positions recorded
+    unsigned capacity;         // Slots allocated in `positions`
+    struct doc_term *next;     // Next term of the document in the same bucket
+    struct doc_term *next_in_doc;  // Next term in the order of first occurrence
+} doc_term;
+
+// A term's postings decoded for query evaluation
+typedef struct decoded_postings {
+    unsigned *docs;            // Doc IDs in increasing order
+    unsigned *offsets;         // Start of each document's positions in `positions` (doc_count + 1 entries)
+    unsigned *positions;       // Positions of all documents, increasing within a document
+    unsigned doc_count;        // Documents in the list
+} decoded_postings;
+
+// Cursor over one segment file during a merge
+typedef struct segment_reader {
+    FILE *file;                // Open segment
+    unsigned remaining;        // Terms not read yet
+    char term[TOKEN_MAX + 1];  // Current term
+    unsigned doc_count;        // Documents of the current term
+    unsigned long last_doc;    // Last doc ID of the current term
+    unsigned char *data;       // Encoded postings of the current term
+    size_t size;               // Bytes in `data`
+    size_t capacity;           // Bytes allocated for `data`
+    int valid;                 // A current term is loaded
+} segment_reader;
+
+// 32-bit FNV-1a hash of a term
+static unsigned term_hash(const char *term) {
+    unsigned hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)term; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Encode an integer as a little-endian base-128 varint; returns the bytes written
+static size_t put_varint(unsigned char *out, unsigned long value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+// Decode a varint from memory and advance the pointer
+static unsigned long get_varint(const unsigned char **p) {
+    unsigned long value = 0;
+    int shift = 0;
+    while (**p & 0x80) {
+        value |= (unsigned long)(*(*p)++ & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= (unsigned long)(*(*p)++) << shift;
+    return value;
+}
+
+// Write a varint to a file
+static void write_varint(FILE *file, unsigned long value) {
+    unsigned char buf[10];
+    fwrite(buf, 1, put_varint(buf, value), file);
+}
+
+// Read a varint from a file; returns 0 at end of file
+static int read_varint(FILE *file, unsigned long *value) {
+    int c, shift = 0;
+    *value = 0;
+    while ((c = getc(file)) != EOF) {
+        *value |= (unsigned long)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return 1;
+        shift += 7;
+    }
+    return 0;
+}
+
+// Path of segment number `n`
+static void segment_path(inverted_index *idx, int n, char *path, size_t size) {
+    snprintf(path, size, "%s/segment-%05d.idx", idx->dir, n);
+}
+
+// Create an empty index writing segments into `dir`
+void index_init(inverted_index *idx, const char *dir, size_t budget) {
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create index directory %s\n", dir);
+    }
+
+    idx->dir = strdup(dir);
+    idx->budget = budget ? budget : INDEX_BUFFER_BYTES;
+    idx->table = (posting_list **)calloc(INDEX_TABLE_SIZE, sizeof(posting_list *));
+    arena_init(&idx->pool, 0);
+    idx->buffered = 0;
+    idx->segment_count = 0;
+
+    idx->doc_urls = NULL;
+    idx->doc_count = 0;
+    idx->doc_capacity = 0;
+    arena_init(&idx->doc_pool, 0);
+
+    idx->segment = NULL;
+    idx->dictionary = NULL;
+    arena_init(&idx->dict_pool, 0);
+}
+
+// Find or create the in-memory postings of a term; the stored hash avoids touching other terms' strings
+static posting_list *get_list(inverted_index *idx, const char *term, unsigned hash) {
+    unsigned long index = hash % INDEX_TABLE_SIZE;
+    posting_list *list;
+    for (list = idx->table[index]; list; list = list->next) {
+        if (list->hash == hash && strcmp(list->term, term) == 0) return list;
+    }
+
+    list = (posting_list *)arena_calloc(&idx->pool, sizeof(posting_list));
+    list->term = arena_strdup(&idx->pool, term);
+    list->hash = hash;
+    list->next = idx->table[index];
+    idx->table[index] = list;
+    return list;
+}
+
+// Append one document's positions to a posting list
+static void append_postings(inverted_index *idx, posting_list *list, unsigned doc, const unsigned *positions, unsigned count) {
+    size_t worst = (size_t)(count + 2) * 5;  // Every varint of a 32-bit value fits in five bytes
+    if (list->size + worst > list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 32;
+        while (new_capacity < list->size + worst) new_capacity *= 2;
+        list->data = (unsigned char *)realloc(list->data, new_capacity);
+        idx->buffered += new_capacity - list->capacity;
+        list->capacity = new_capacity;
+    }
+
+    unsigned char *out = list->data + list->size;
+    out += put_varint(out, doc - (list->doc_count ? list->last_doc : 0));
+    out += put_varint(out, count);
+    unsigned previous = 0;
+    for (unsigned i = 0; i < count; i++) {
+        out += put_varint(out, positions[i] - previous);
+        previous = positions[i];
+    }
+
+    list->size = out - list->data;
+    list->doc_count++;
+    list->last_doc = doc;
+}
+
+// Tokenize a document into the index and return its doc ID; stop words are not indexed but still take a position
+unsigned index_add_document(inverted_index *idx, const char *url, const char *text, size_t length, arena *scratch) {
+    unsigned doc = idx->doc_count++;
+    if (doc == idx->doc_capacity) {
+        idx->doc_capacity = idx->doc_capacity ? idx->doc_capacity * 2 : 1024;
+        idx->doc_urls = (char **)realloc(idx->doc_urls, idx->doc_capacity * sizeof(char *));
+    }
+    idx->doc_urls[doc] = arena_strdup(&idx->doc_pool, url);
+
+    // Group positions by term for this document only
+    enum { DOC_BUCKETS = 4096 };
+    doc_term **buckets = (doc_term **)arena_calloc(scratch, DOC_BUCKETS * sizeof(doc_term *));
+    doc_term *first = NULL, *last = NULL;
+
+    tokenizer tk;
+    char token[TOKEN_MAX + 1];
+    size_t token_length;
+    unsigned position = 0;
+
+    tokenizer_init(&tk, text, length);
+    while ((token_length = next_token(&tk, token)) > 0) {
+        if (is_stop_word(token, token_length)) {
+            position++;
+            continue;
+        }
+
+        unsigned hash = term_hash(token);
+        unsigned long bucket = hash % DOC_BUCKETS;
+        doc_term *dt;
+        for (dt = buckets[bucket]; dt; dt = dt->next) {
+            if (dt->list->hash == hash && strcmp(dt->list->term, token) == 0) break;
+        }
+        if (!dt) {
+            dt = (doc_term *)arena_calloc(scratch, sizeof(doc_term));
+            dt->list = get_list(idx, token, hash);
+            dt->next = buckets[bucket];
+            buckets[bucket] = dt;
+            if (last) last->next_in_doc = dt; else first = dt;
+            last = dt;
+        }
+
+        if (dt->count == dt->capacity) {
+            unsigned new_capacity = dt->capacity ? dt->capacity * 2 : 4;
+            unsigned *grown = (unsigned *)arena_alloc(scratch, new_capacity * sizeof(unsigned));
+            if (dt->count) memcpy(grown, dt->positions, dt->count * sizeof(unsigned));
+            dt->positions = grown;
+            dt->capacity = new_capacity;
+        }
+        dt->positions[dt->count++] = position++;
+    }
+
+    for (doc_term *dt = first; dt; dt = dt->next_in_doc) {
+        append_postings(idx, dt->list, doc, dt->positions, dt->count);
+    }
+
+    // Keep the buffer within its budget
+    if (idx->buffered + idx->pool.used >= idx->budget) {
+        index_flush(idx);
+    }
+    return doc;
+}
+
+// Order posting lists by term
+static int compare_lists(const void *a, const void *b) {
+    return strcmp((*(posting_list *const *)a)->term, (*(posting_list *const *)b)->term);
+}
+
+// Write the header of a segment; the term count is patched in by finish_segment
+static FILE *create_segment(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write index segment %s\n", path);
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, SEGMENT_IO_BUFFER);
+    fwrite(SEGMENT_MAGIC, 1, 4, file);
+    fwrite("\0\0\0\0", 1, 4, file);
+    return file;
+}
+
+// Store the term count in the segment header and close it
+static void finish_segment(FILE *file, unsigned long term_count) {
+    unsigned char count[4] = {
+        (unsigned char)term_count, (unsigned char)(term_count >> 8),
+        (unsigned char)(term_count >> 16), (unsigned char)(term_count >> 24)
+    };
+    fseek(file, 4, SEEK_SET);
+    fwrite(count, 1, 4, file);
+    fclose(file);
+}
+
+// Write one term record
+static void write_term(FILE *file, const char *term, unsigned doc_count, unsigned long last_doc, const unsigned char *data, size_t size) {
+    size_t term_length = strlen(term);
+    write_varint(file, term_length);
+    fwrite(term, 1, term_length, file);
+    write_varint(file, doc_count);
+    write_varint(file, last_doc);
+    write_varint(file, size);
+    fwrite(data, 1, size, file);
+}
+
+// Write the in-memory buffer to a new segment file with its terms in sorted order
+void index_flush(inverted_index *idx) {
+    size_t term_count = 0;
+    for (int i = 0; i < INDEX_TABLE_SIZE; i++) {
+        for (posting_list *list = idx->table[i]; list; list = list->next) term_count++;
+    }
+    if (term_count == 0) return;
+
+    posting_list **lists = (posting_list **)malloc(term_count * sizeof(posting_list *));
+    size_t n = 0;
+    for (int i = 0; i < INDEX_TABLE_SIZE; i++) {
+        for (posting_list *list = idx->table[i]; list; list = list->next) lists[n++] = list;
+    }
+    qsort(lists, term_count, sizeof(posting_list *), compare_lists);
+
+    char path[512];
+    segment_path(idx, idx->segment_count, path, sizeof(path));
+    FILE *file = create_segment(path);
+    if (file) {
+        for (size_t i = 0; i < term_count; i++) {
+            write_term(file, lists[i]->term, lists[i]->doc_count, lists[i]->last_doc, lists[i]->data, lists[i]->size);
+        }
+        finish_segment(file, term_count);
+        idx->segment_count++;
+    }
+
+    // Release the buffer
+    for (size_t i = 0; i < term_count; i++) free(lists[i]->data);
+    free(lists);
+    memset(idx->table, 0, INDEX_TABLE_SIZE * sizeof(posting_list *));
+    arena_reset(&idx->pool);
+    idx->buffered = 0;
+}
+
+// Load the next term of a segment into its reader
+static void reader_next(segment_reader *r) {
+    unsigned long term_length, doc_count, size;
+    r->valid = 0;
+    if (r->remaining == 0 || !read_varint(r->file, &term_length) || term_length > TOKEN_MAX) return;
+
+    if (fread(r->term, 1, term_length, r->file) != term_length) return;
+    r->term[term_length] = '\0';
+    if (!read_varint(r->file, &doc_count) || !read_varint(r->file, &r->last_doc) || !read_varint(r->file, &size)) return;
+
+    if (size > r->capacity) {
+        r->capacity = size;
+        r->data = (unsigned char *)realloc(r->data, size);
+    }
+    if (fread(r->data, 1, size, r->file) != size) return;
+
+    r->doc_count = (unsigned)doc_count;
+    r->size = size;
+    r->remaining--;
+    r->valid = 1;
+}
+
+// Open a segment and position its reader on the first term
+static int reader_open(segment_reader *r, const char *path) {
+    unsigned char header[8];
+    memset(r, 0, sizeof(*r));
+    r->file = fopen(path, "rb");
+    if (!r->file) return 0;
+
+    setvbuf(r->file, NULL, _IOFBF, SEGMENT_READ_BUFFER);
+    if (fread(header, 1, 8, r->file) != 8 || memcmp(header, SEGMENT_MAGIC, 4) != 0) {
+        fclose(r->file);
+        r->file = NULL;
+        return 0;
+    }
+    r->remaining = header[4] | (header[5] << 8) | (header[6] << 16) | ((unsigned)header[7] << 24);
+    reader_next(r);
+    return 1;
+}
+
+// Merge segments first..first+count-1 into `merged_path` and remove them; lists of the same term are
+// concatenated in segment (and so doc ID) order
+static int merge_range(inverted_index *idx, int first, int count, const char *merged_path) {
+    segment_reader *readers = (segment_reader *)calloc(count, sizeof(segment_reader));
+    char path[512];
+    for (int i = 0; i < count; i++) {
+        segment_path(idx, first + i, path, sizeof(path));
+        reader_open(&readers[i], path);
+    }
+
+    FILE *out = create_segment(merged_path);
+    if (!out) {
+        for (int i = 0; i < count; i++) {
+            if (readers[i].file) fclose(readers[i].file);
+            free(readers[i].data);
+        }
+        free(readers);
+        return 0;
+    }
+
+    unsigned char *merged = NULL;
+    size_t merged_capacity = 0;
+    unsigned long term_count = 0;
+
+    for (;;) {
+        // Smallest current term over all readers
+        const char *smallest = NULL;
+        for (int i = 0; i < count; i++) {
+            if (readers[i].valid && (!smallest || strcmp(readers[i].term, smallest) < 0)) smallest = readers[i].term;
+        }
+        if (!smallest) break;
+
+        char term[TOKEN_MAX + 1];
+        strcpy(term, smallest);
+
+        size_t size = 0;
+        unsigned doc_count = 0;
+        unsigned long last_doc = 0;
+        for (int i = 0; i < count; i++) {
+            segment_reader *r = &readers[i];
+            if (!r->valid || strcmp(r->term, term) != 0) continue;
+
+            if (size + r->size + 10 > merged_capacity) {
+                merged_capacity = (size + r->size + 10) * 2;
+                merged = (unsigned char *)realloc(merged, merged_capacity);
+            }
+
+            // The first doc ID of each segment is absolute; rebase it on the previous segment's last doc
+            const unsigned char *p = r->data;
+            unsigned long first_doc = get_varint(&p);
+            size += put_varint(merged + size, doc_count ? first_doc - last_doc : first_doc);
+            size_t rest = r->size - (p - r->data);
+            memcpy(merged + size, p, rest);
+            size += rest;
+
+            doc_count += r->doc_count;
+            last_doc = r->last_doc;
+            reader_next(r);
+        }
+
+        write_term(out, term, doc_count, last_doc, merged, size);
+        term_count++;
+    }
+    finish_segment(out, term_count);
+
+    for (int i = 0; i < count; i++) {
+        if (readers[i].file) fclose(readers[i].file);
+        free(readers[i].data);
+        segment_path(idx, first + i, path, sizeof(path));
+        remove(path);
+    }
+    free(readers);
+    free(merged);
+    return 1;
+}
+
+// Merge every segment into one, MERGE_FANIN segments at a time; consecutive groups keep doc IDs in order
+static void merge_segments(inverted_index *idx) {
+    char merged_path[512], path[512];
+    snprintf(merged_path, sizeof(merged_path), "%s/merge.tmp", idx->dir);
+
+    while (idx->segment_count > 1) {
+        int groups = 0;
+        for (int first = 0; first < idx->segment_count; first += MERGE_FANIN) {
+            int count = idx->segment_count - first < MERGE_FANIN ? idx->segment_count - first : MERGE_FANIN;
+            if (!merge_range(idx, first, count, merged_path)) return;
+
+            // Group n becomes segment n; its slot was one of the inputs just removed
+            segment_path(idx, groups++, path, sizeof(path));
+            rename(merged_path, path);
+        }
+        idx->segment_count = groups;
+    }
+}
+
+// Read the merged segment's term directory so queries can seek straight to a term's postings
+static void load_dictionary(inverted_index *idx) {
+    char path[512];
+    segment_path(idx, 0, path, sizeof(path));
+
+    segment_reader r;
+    if (!reader_open(&r, path)) return;
+    idx->dictionary = (term_entry **)calloc(INDEX_TABLE_SIZE, sizeof(term_entry *));
+
+    // reader_open already loaded the first term; walk the file recording where each term's data starts
+    while (r.valid) {
+        term_entry *entry = (term_entry *)arena_alloc(&idx->dict_pool, sizeof(term_entry));
+        entry->term = arena_strdup(&idx->dict_pool, r.term);
+        entry->offset = ftell(r.file) - (long)r.size;
+        entry->size = r.size;
+        entry->doc_count = r.doc_count;
+
+        unsigned long bucket = term_hash(entry->term) % INDEX_TABLE_SIZE;
+        entry->next = idx->dictionary[bucket];
+        idx->dictionary[bucket] = entry;
+        reader_next(&r);
+    }
+    free(r.data);
+    fclose(r.file);
+
+    // Queries seek straight to each term, so the file is reopened without a large read buffer
+    idx->segment = fopen(path, "rb");
+}
+
+// Flush the buffer, merge every segment into one and open it for queries
+void index_finish(inverted_index *idx) {
+    index_flush(idx);
+    merge_segments(idx);
+    if (idx->segment_count > 0) load_dictionary(idx);
+}
+
+// Read and decode the postings of a term; returns 0 if the term is not indexed
+static int load_postings(inverted_index *idx, const char *term, decoded_postings *out) {
+    if (!idx->dictionary || !idx->segment) return 0;
+
+    term_entry *entry;
+    for (entry = idx->dictionary[term_hash(term) % INDEX_TABLE_SIZE]; entry; entry = entry->next) {
+        if (strcmp(entry->term, term) == 0) break;
+    }
+    if (!entry) return 0;
+
+    unsigned char *data = (unsigned char *)malloc(entry->size + 1);
+    fseek(idx->segment, entry->offset, SEEK_SET);
+    if (fread(data, 1, entry->size, idx->segment) != entry->size) {
+        free(data);
+        return 0;
+    }
+
+    // Every position takes at least one byte, which bounds the number of positions
+    out->docs = (unsigned *)malloc(entry->doc_count * sizeof(unsigned));
+    out->offsets = (unsigned *)malloc((entry->doc_count + 1) * sizeof(unsigned));
+    out->positions = (unsigned *)malloc((entry->size + 1) * sizeof(unsigned));
+    out->doc_count = entry->doc_count;
+
+    const unsigned char *p = data;
+    unsigned doc = 0, n = 0;
+    for (unsigned i = 0; i < entry->doc_count; i++) {
+        doc += (unsigned)get_varint(&p);
+        unsigned freq = (unsigned)get_varint(&p);
+        unsigned position = 0;
+        out->docs[i] = doc;
+        out->offsets[i] = n;
+        for (unsigned j = 0; j < freq; j++) {
+            position += (unsigned)get_varint(&p);
+            out->positions[n++] = position;
+        }
+    }
+    out->offsets[entry->doc_count] = n;
+
+    free(data);
+    return 1;
+}
+
+// Free decoded postings
+static void free_postings(decoded_postings *d) {
+    free(d->docs);
+    free(d->offsets);
+    free(d->positions);
+}
+
+// Binary search for a position in a sorted slice
+static int has_position(const unsigned *positions, unsigned count, unsigned target) {
+    unsigned lo = 0, hi = count;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (positions[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < count && positions[lo] == target;
+}
+
+// Check one document: exact phrase when window is 0, otherwise all terms inside a span of `window` positions
+static int match_document(decoded_postings *terms, unsigned *cursor, const unsigned *offsets_in_query, int term_count, int window) {
+    const unsigned *slice[MAX_QUERY_TERMS];
+    unsigned length[MAX_QUERY_TERMS];
+    for (int i = 0; i < term_count; i++) {
+        decoded_postings *d = &terms[i];
+        slice[i] = d->positions + d->offsets[cursor[i]];
+        length[i] = d->offsets[cursor[i] + 1] - d->offsets[cursor[i]];
+    }
+
+    if (window == 0) {
+        for (unsigned j = 0; j < length[0]; j++) {
+            if (slice[0][j] < offsets_in_query[0]) continue;
+            unsigned start = slice[0][j] - offsets_in_query[0];
+            int i;
+            for (i = 1; i < term_count; i++) {
+                if (!has_position(slice[i], length[i], start + offsets_in_query[i])) break;
+            }
+            if (i == term_count) return 1;
+        }
+        return 0;
+    }
+
+    // Slide a window over the merged positions, always advancing the term with the smallest position
+    unsigned at[MAX_QUERY_TERMS] = { 0 };
+    for (;;) {
+        int min_term = 0;
+        unsigned min = slice[0][at[0]], max = min;
+        for (int i = 1; i < term_count; i++) {
+            unsigned value = slice[i][at[i]];
+            if (value < min) {
+                min = value;
+                min_term = i;
+            }
+            if (value > max) max = value;
+        }
+        if (max - min <= (unsigned)window) return 1;
+        if (++at[min_term] == length[min_term]) return 0;
+    }
+}
+
+// Find documents containing the query as a phrase (window 0) or with all its terms within `window` positions;
+// stores a malloc'd array of doc IDs in *docs and returns its length
+int index_search(inverted_index *idx, const char *query, int window, unsigned **docs) {
+    char terms[MAX_QUERY_TERMS][TOKEN_MAX + 1];
+    unsigned offsets_in_query[MAX_QUERY_TERMS];
+    int term_count = 0;
+    *docs = NULL;
+
+    // Tokenize the query like a document so positions line up with the index
+    tokenizer tk;
+    size_t token_length;
+    unsigned position = 0;
+    tokenizer_init(&tk, query, strlen(query));
+    while (term_count < MAX_QUERY_TERMS && (token_length = next_token(&tk, terms[term_count])) > 0) {
+        if (!is_stop_word(terms[term_count], token_length)) {
+            offsets_in_query[term_count++] = position;
+        }
+        position++;
+    }
+    if (term_count == 0) return 0;
+
+    decoded_postings postings[MAX_QUERY_TERMS];
+    int loaded = 0;
+    for (; loaded < term_count; loaded++) {
+        if (!load_postings(idx, terms[loaded], &postings[loaded])) break;
+    }
+
+    int found = 0;
+    if (loaded == term_count) {
+        *docs = (unsigned *)malloc(postings[0].doc_count * sizeof(unsigned));
+
+        // Walk the first term's documents, advancing the other lists in step
+        unsigned cursor[MAX_QUERY_TERMS] = { 0 };
+        for (; cursor[0] < postings[0].doc_count; cursor[0]++) {
+            unsigned doc = postings[0].docs[cursor[0]];
+            int i;
+            for (i = 1; i < term_count; i++) {
+                while (cursor[i] < postings[i].doc_count && postings[i].docs[cursor[i]] < doc) cursor[i]++;
+                if (cursor[i] == postings[i].doc_count || postings[i].docs[cursor[i]] != doc) break;
+            }
+            if (i < term_count) continue;
+
+            if (match_document(postings, cursor, offsets_in_query, term_count, window)) {
+                (*docs)[found++] = doc;
+            }
+        }
+    }
+
+    for (int i = 0; i < loaded; i++) free_postings(&postings[i]);
+    return found;
+}
+
+// Return the URL of a document
+const char *index_doc_url(inverted_index *idx, unsigned doc) {
+    return doc < idx->doc_count ? idx->doc_urls[doc] : NULL;
+}
+
+// Bytes held in memory by the index: buffered postings, document URLs and the query dictionary
+size_t index_memory(const inverted_index *idx) {
+    size_t bytes = INDEX_TABLE_SIZE * sizeof(posting_list *) + idx->pool.reserved + idx->buffered;
+    bytes += idx->doc_capacity * sizeof(char *) + idx->doc_pool.reserved;
+    if (idx->dictionary) bytes += INDEX_TABLE_SIZE * sizeof(term_entry *) + idx->dict_pool.reserved;
+    return bytes;
+}
+
+// Close the index and free its memory; segment files stay on disk
+void index_free(inverted_index *idx) {
+    for (int i = 0; i < INDEX_TABLE_SIZE; i++) {
+        for (posting_list *list = idx->table[i]; list; list = list->next) free(list->data);
+    }
+    free(idx->table);
+    arena_free(&idx->pool);
+
+    free(idx->doc_urls);
+    arena_free(&idx->doc_pool);
+
+    if (idx->segment) fclose(idx->segment);
+    free(idx->dictionary);
+    arena_free(&idx->dict_pool);
+    free(idx->dir);
+}
@@ -0,0 +1,60 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "arena.h"
+
+#define INDEX_BUFFER_BYTES (64 * 1024 * 1024)  // Default size of the in-memory postings buffer before it is flushed
+#define INDEX_TABLE_SIZE 65536                 // Buckets of the in-memory and on-disk term dictionaries
+
+// Postings of one term: for each document, the doc ID delta, the term frequency and the position deltas, all as varints
+typedef struct posting_list {
+    char *term;                 // Case-folded term
+    unsigned hash;              // Hash of the term, compared before the string
+    unsigned char *data;        // Encoded postings
+    size_t size;                // Bytes used in `data`
+    size_t capacity;            // Bytes allocated for `data`
+    unsigned doc_count;         // Documents containing the term
+    unsigned last_doc;          // Last document appended, the base of the next doc ID delta
+    struct posting_list *next;  // Next list in the same bucket
+} posting_list;
+
+// Location of a term's postings in the merged segment
+typedef struct term_entry {
+    char *term;                 // Case-folded term
+    long offset;                // File offset of the encoded postings
+    size_t size;                // Length of the encoded postings
+    unsigned doc_count;         // Documents containing the term
+    struct term_entry *next;    // Next entry in the same bucket
+} term_entry;
+
+// Positional inverted index: postings are buffered in memory, flushed to sorted segment files and merged at the end
+typedef struct inverted_index {
+    char *dir;                                // Directory holding the segment files
+    size_t budget;                            // Buffered bytes that trigger a flush
+    posting_list **table;                     // In-memory postings of the current buffer (INDEX_TABLE_SIZE buckets)
+    arena pool;                               // Terms and list headers of the current buffer
+    size_t buffered;                          // Bytes of postings held in memory
+    int segment_count;                        // Segment files written so far
+
+    char **doc_urls;                          // URL of each document, indexed by doc ID
+    unsigned doc_count;                       // Documents added
+    unsigned doc_capacity;                    // Slots allocated in `doc_urls`
+    arena doc_pool;                           // Storage for the URLs
+
+    FILE *segment;                            // Merged segment opened for queries, NULL while crawling
+    term_entry **dictionary;                  // Terms of the merged segment (INDEX_TABLE_SIZE buckets)
+    arena dict_pool;                          // Storage for the dictionary
+} inverted_index;
+
+void index_init(inverted_index *idx, const char *dir, size_t budget); // Create an empty index writing segments into `dir` (budget 0 selects INDEX_BUFFER_BYTES)
+unsigned index_add_document(inverted_index *idx, const char *url, const char *text, size_t length, arena *scratch); // Tokenize a document into the index; returns its doc ID
+void index_flush(inverted_index *idx); // Write the in-memory buffer to a new sorted segment file
+void index_finish(inverted_index *idx); // Flush, merge every segment into one and open it for queries
+int index_search(inverted_index *idx, const char *query, int window, unsigned **docs); // Find documents containing the query as a phrase (window 0) or with all terms within `window` positions
+const char *index_doc_url(inverted_index *idx, unsigned doc); // Return the URL of a document
+size_t index_memory(const inverted_index *idx); // Bytes held in memory by the index
+void index_free(inverted_index *idx); // Close the index and free its memory
+
+#endif
@@ -1,16 +1,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <curl/curl.h>
 #include <ctype.h>
-#include "queue.h"
+#include <sys/resource.h>
+#include "frontier.h"
 #include "trie.h"
 #include "hashmap.h"
+#include "robots.h"
+#include "arena.h"
+#include "tokenizer.h"
+#include "text.h"
+#include "index.h"
+#include "graph.h"
+#include "output.h"
+#include "memory.h"
+
+#define ANCHOR_TEXT_MAX 1024  // Bytes after an <a> tag searched for its closing </a>
 
 // Data structure to store the response from a URL
 typedef struct {
-    char *data;   // Pointer to store response data
-    size_t size;  // Size of the data
+    char *data;       // Pointer to store response data
+    size_t size;      // Size of the data
+    size_t capacity;  // Bytes allocated for `data`, kept across pages so the buffer is reused
 } ResponseData;
 
 // Callback function to handle the response data
@@ -21,13 +34,20 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *respdata)
     // Cast the response data pointer
     ResponseData *respdata2 = (ResponseData *)respdata;
 
-    // Reallocate memory to store the new data
-    char *new_data = realloc(respdata2->data, respdata2->size + total_size + 1);
-    if (new_data == NULL) {
-        return CURLE_WRITE_ERROR;  // Return error if memory allocation fails
+    // Grow the buffer geometrically only when the new data does not fit
+    if (respdata2->size + total_size + 1 > respdata2->capacity) {
+        size_t new_capacity = respdata2->capacity ? respdata2->capacity : 16384;
+        while (new_capacity < respdata2->size + total_size + 1) new_capacity *= 2;
+
+        char *new_data = realloc(respdata2->data, new_capacity);
+        if (new_data == NULL) {
+            return CURLE_WRITE_ERROR;  // Return error if memory allocation fails
+        }
+
+        respdata2->data = new_data;  // Update the pointer to the reallocated memory
+        respdata2->capacity = new_capacity;
     }
 
-    respdata2->data = new_data;  // Update the pointer to the reallocated memory
     memcpy(&(respdata2->data[respdata2->size]), contents, total_size);  // Copy new data into memory
     respdata2->size += total_size;  // Update the total size
     respdata2->data[respdata2->size] = '\0';  // Null-terminate the data
@@ -35,6 +55,15 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *respdata)
     return total_size;  // Return the size of processed data
 }
 
+// Callback function to collect the response headers; a new status line (after a redirect) starts over
+size_t HeaderCallback(char *buffer, size_t size, size_t nitems, void *headers) {
+    ResponseData *headers2 = (ResponseData *)headers;
+    if (size * nitems >= 5 && strncmp(buffer, "HTTP/", 5) == 0) {
+        headers2->size = 0;  // Keep only the headers of the final response
+    }
+    return WriteCallback(buffer, size, nitems, headers);
+}
+
 // Function to check if a URL is valid
 int is_valid_URL(char *url) {
     // Invalid if it starts with '#' or contains "javascript:" or "mailto:"
@@ -64,8 +93,18 @@ void extract_base_url(char *url, char *base_url, size_t max_length) {
     }
 }
 
+// Function to find the </a> closing an anchor text, in any case and within ANCHOR_TEXT_MAX bytes; NULL if another <a> starts first
+char *find_anchor_end(char *text) {
+    for (size_t i = 0; i < ANCHOR_TEXT_MAX && text[i]; i++) {
+        if (text[i] != '<') continue;
+        if (strncasecmp(text + i, "</a>", 4) == 0) return text + i;
+        if (strncasecmp(text + i, "<a ", 3) == 0) return NULL;
+    }
+    return NULL;
+}
+
 // Function to find and process all <a> tags in the HTML
-void find_links(char *url, char *html, HashMap *hashmap, queue *q, int depth) {
+void find_links(char *url, char *html, HashMap *hashmap, frontier *f, robots_cache *robots, link_graph *graph, page_record *record, arena *scratch, int depth) {
     char *a_tag_start = "<a ";    // Start of an <a> tag
     char *href_start = "href=\""; // Start of an href attribute
     char *href_end = "\"";        // End of an href attribute
@@ -73,6 +112,8 @@ void find_links(char *url, char *html, HashMap *hashmap, queue *q, int depth) {
     char base_url[256];
     extract_base_url(url, base_url, sizeof(base_url));  // Extract base URL for resolving relative links
 
+    uint32_t source = graph_url_id(graph, url);  // Graph node of the page being parsed
+
     char *pos = html;  // Pointer to traverse HTML
 
     while ((pos = strstr(pos, a_tag_start)) != NULL) {
@@ -88,38 +129,49 @@ void find_links(char *url, char *html, HashMap *hashmap, queue *q, int depth) {
             if (href_close) {
                 size_t link_length = href_close - href_pos;
 
-                // Allocate memory to store the extracted URL
-                char *link = (char *)malloc(link_length + 1);
-                strncpy(link, href_pos, link_length);
-                link[link_length] = '\0';  // Null-terminate the URL
+                // Copy the extracted URL into the per-page scratch arena
+                char *link = arena_strndup(scratch, href_pos, link_length);
 
                 if (is_valid_URL(link)) {
                     // Handle relative URLs by prepending the base URL
                     if (link[0] == '/') {
-                        char *new_link = (char *)malloc(strlen(base_url) + strlen(link) + 1);
+                        char *new_link = (char *)arena_alloc(scratch, strlen(base_url) + strlen(link) + 1);
                         strcpy(new_link, base_url);
                         strcat(new_link, link);
-                        free(link);
                         link = new_link;
                     }
                     // Handle "www." links by prepending "http://"
                     else if (strncmp(link, "www.", 4) == 0) {
-                        char *new_link = (char *)malloc(strlen("http://") + strlen(link) + 1);
+                        char *new_link = (char *)arena_alloc(scratch, strlen("http://") + strlen(link) + 1);
                         strcpy(new_link, "http://");
                         strcat(new_link, link);
-                        free(link);
                         link = new_link;
                     }
 
-                    // Insert the URL into the hashmap and queue if it's not already visited
+                    graph_add_edge(graph, source, graph_url_id(graph, link));  // Record the edge even if the target was seen before
+                    record_add(record, OUTPUT_LINK, link, strlen(link));  // Keep the link in the page's output record
+
+                    // Count focus terms in the anchor text, which runs from the end of the tag to </a>
+                    unsigned anchor_hits = 0;
+                    char *text_start = strchr(href_close, '>');
+                    char *text_end = text_start ? find_anchor_end(text_start) : NULL;
+                    if (text_end) {
+                        anchor_hits = frontier_anchor_hits(f, text_start + 1, text_end - text_start - 1);
+                    }
+
+                    // Insert the URL into the hashmap and frontier if it's not already visited; a link
+                    // beyond maxdepth is not marked, so a shallower page can still queue it later
                     if (!search_url(hashmap, link)) {
-                        insert_url(hashmap, link);  // Add to hashmap
-                        enqueue(q, link, depth + 1);  // Add to the queue
-                        printf("Found link: %s\n", link);
+                        if (depth + 1 <= f->max_depth) {
+                            insert_url(hashmap, link);  // Add to hashmap so the robots check runs once per link
+                            if (robots_allowed(robots, link)) {
+                                frontier_push(f, link, depth + 1, anchor_hits);  // Add to the frontier
+                            }
+                        }
+                    } else {
+                        frontier_add_inlink(f, link, depth + 1, anchor_hits);  // Raise the priority if it is still waiting
                     }
                 }
-
-                free(link);  // Free allocated memory for the link
             }
         }
 
@@ -127,49 +179,56 @@ void find_links(char *url, char *html, HashMap *hashmap, queue *q, int depth) {
     }
 }
 
-// Function to fetch HTML content from a URL
-void gethtml(CURL *curl, char *url, ResponseData *response) {
+// Function to fetch HTML content and headers from a URL; returns the HTTP status, or 0 if the request failed
+long gethtml(CURL *curl, char *url, ResponseData *response, ResponseData *headers) {
     curl_easy_setopt(curl, CURLOPT_URL, url);  // Set the target URL
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);  // Set the write callback function
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);  // Follow redirects if necessary
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, ROBOTS_AGENT);  // Identify as the agent whose robots.txt rules are applied
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)response);  // Pass response data struct
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);  // Set the header callback function
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)headers);  // Pass header data struct
+
+    headers->size = 0;
+    headers->data[0] = '\0';
 
+    long status = 0;
     CURLcode res = curl_easy_perform(curl);  // Perform the HTTP request
     if (res != CURLE_OK) {
         fprintf(stderr, "Invalid URL: %s\n", curl_easy_strerror(res));  // Log error if request fails
+    } else {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);  // Status of the final response
     }
+    return status;
 }
 
-// Stop words list
-const char *stop_words[] = {
-    "the", "and", "in", "of", "to", "a", "with", "for", "is", "on", "by", "this", "it", "at", "from", "or"
-};
-const int stop_words_count = sizeof(stop_words) / sizeof(stop_words[0]);
-
-// Check if a word is a stop word
-int is_stop_word(const char *word) {
-    for (int i = 0; i < stop_words_count; i++) {
-        if (strcasecmp(word, stop_words[i]) == 0) {
-            return 1;  // Return true if it is a stop word
+// Tokenize a span of text and insert each new, non-stop-word token into the trie
+void index_text(trie *t, HashMap *seen, const char *text, size_t length, char *url, page_record *record) {
+    tokenizer tk;
+    char token[TOKEN_MAX + 1];
+    size_t token_length;
+
+    tokenizer_init(&tk, text, length);
+    while ((token_length = next_token(&tk, token)) > 0) {
+        // Add token to keywords if it's not a stop word and not already processed
+        if (!is_stop_word(token, token_length) && !search_url(seen, token)) {
+            insert_url(seen, token); // Mark the token as processed
+            insert_trie(t, token, url); // Insert into the trie
+            record_add(record, OUTPUT_KEYWORD, token, token_length); // Keep the keyword in the page's output record
         }
     }
-    return 0;  // Not a stop word
 }
 
-// Function to extract the title and meta tag contents from HTML
-void get_keywords(trie *t, char *html, char *url) {
+// Function to extract the title and meta tag contents from HTML; temporaries live in the scratch arena
+void get_keywords(trie *t, char *html, char *url, page_record *record, arena *scratch) {
     HashMap h;
-    init_hashmap(&h); // Initialize a hashmap to track processed keywords
+    init_hashmap_arena(&h, scratch); // Initialize a hashmap to track processed keywords
     
     // Pointer to find the <title> tag in the HTML
     const char *title_tag_start = "<title>";
     const char *title_tag_end = "</title>";
     
     char *title_start = strstr(html, title_tag_start); // Locate <title> tag start
-    int keyword_count = 0; // Count of unique keywords extracted
-    char **keywords = malloc(100 * sizeof(char *)); // Allocate memory for keywords
-    char *text_copy;
-    char *token;
 
     // Extract the title content if the <title> tag is found
     if (title_start) {
@@ -178,29 +237,7 @@ void get_keywords(trie *t, char *html, char *url) {
         
         if (title_end) {
             size_t title_length = title_end - title_start; // Calculate title length
-            char *title = (char *)malloc(title_length + 1); // Allocate memory for the title
-            strncpy(title, title_start, title_length); // Copy title content
-            title[title_length] = '\0'; // Null-terminate the title
-            
-            text_copy = strdup(title); // Duplicate the title text for tokenization
-            token = strtok(text_copy, " ,.-&:;/#%\\"); // Tokenize using common delimiters
-            
-            while (token != NULL) {
-                // Convert token to lowercase for case-insensitive comparisons
-                for (char *p = token; *p; p++) *p = tolower(*p);
-
-                // Add token to keywords if it's not a stop word and not already processed
-                if (!is_stop_word(token) && !search_url(&h, token)) {
-                    insert_url(&h, token); // Mark the token as processed
-                    keywords[keyword_count] = strdup(token); // Save the keyword
-                    insert_trie(t, token, url); // Insert into the trie
-                    (keyword_count)++; // Increment keyword count
-                }
-                token = strtok(NULL, " ,.-&:;/#%\\"); // Get the next token
-            }
-
-            free(text_copy); // Free the duplicated text
-            free(title); // Free the allocated memory for the title
+            index_text(t, &h, title_start, title_length, url, record); // Tokenize the title in place
         }
     }
 
@@ -219,110 +256,318 @@ void get_keywords(trie *t, char *html, char *url) {
             name_pos += strlen(meta_name_attr);
             const char *name_end = strchr(name_pos, '"');
             size_t name_length = name_end - name_pos;
-            char *name = (char *)malloc(name_length + 1);
-            strncpy(name, name_pos, name_length);
-            name[name_length] = '\0';
             
             // Check if the name attribute is "keywords" or "description"
-            if (strcmp(name, "keywords") == 0 || strcmp(name, "description") == 0) {
+            if ((name_length == 8 && strncmp(name_pos, "keywords", 8) == 0) ||
+                (name_length == 11 && strncmp(name_pos, "description", 11) == 0)) {
                 // Extract the 'content' attribute value
                 content_pos += strlen(meta_content_attr);
                 const char *content_end = strchr(content_pos, '"');
                 size_t content_length = content_end - content_pos;
-                char *content = (char *)malloc(content_length + 1);
-                strncpy(content, content_pos, content_length);
-                content[content_length] = '\0';
-
-                text_copy = strdup(content); // Duplicate the content for tokenization
-                token = strtok(text_copy, " ,.-&:;/#%\\"); // Tokenize the content
-                
-                while (token != NULL) {
-                    // Convert token to lowercase
-                    for (char *p = token; *p; p++) *p = tolower(*p);
-
-                    // Add token to keywords if it's valid
-                    if (!is_stop_word(token) && !search_url(&h, token)) {
-                        insert_url(&h, token); // Mark as processed
-                        keywords[keyword_count] = strdup(token); // Save the keyword
-                        insert_trie(t, token, url); // Insert into the trie
-                        (keyword_count)++; // Increment keyword count
-                    }
-                    token = strtok(NULL, " ,.-&:;/#%\\"); // Get the next token
-                }
-
-                free(text_copy); // Free duplicated content
-                free(content); // Free allocated content memory
+                index_text(t, &h, content_pos, content_length, url, record); // Tokenize the content in place
             }
-            free(name); // Free allocated name memory
         }
         meta_pos++; // Move to the next potential meta tag
     }
 }
 
+// Function to make the words of a page's title the focus of the crawl
+void add_title_focus(frontier *f, char *html) {
+    char *title_start = strstr(html, "<title>");
+    if (title_start) {
+        title_start += strlen("<title>");
+        char *title_end = strstr(title_start, "</title>");
+        if (title_end) {
+            frontier_add_focus(f, title_start, title_end - title_start);
+        }
+    }
+}
+
+// Function to index the visible body text of a page for phrase and proximity search
+void index_body(inverted_index *idx, char *html, char *url, arena *scratch) {
+    size_t length;
+    char *text = extract_body_text(scratch, html, &length); // Strip tags, scripts and styles
+    index_add_document(idx, url, text, length, scratch); // Add the positions of every token
+}
+
+// A search result with the PageRank score used to order it
+typedef struct {
+    const char *url;  // Matching page
+    double score;     // graph_score of the page
+} ranked_url;
+
+// Comparison function for qsort: highest score first
+int compare_ranked(const void *a, const void *b) {
+    double x = ((const ranked_url *)a)->score, y = ((const ranked_url *)b)->score;
+    return (x < y) - (x > y);
+}
+
+// Function to print result URLs ordered by PageRank
+void print_ranked(link_graph *graph, ranked_url *results, int count) {
+    for (int i = 0; i < count; i++) {
+        results[i].score = graph_score(graph, results[i].url);
+    }
+    qsort(results, count, sizeof(ranked_url), compare_ranked);
+    for (int i = 0; i < count; i++) {
+        printf("%s (rank %.2f)\n", results[i].url, results[i].score);
+    }
+}
+
+// Function to search the title and meta keywords and print the matching URLs by rank
+void search_keyword(trie *t, link_graph *graph, char *keyword) {
+    SLL urls = lookup_trie(t, keyword);
+    int count = len(urls);
+
+    if (count == 0) {
+        printf("Keyword not found\n");
+        return;
+    }
+
+    ranked_url *results = (ranked_url *)malloc(count * sizeof(ranked_url));
+    int i = 0;
+    for (sll_node *n = urls; n != NULL; n = n->next) {
+        results[i++].url = n->url;
+    }
+    printf("Keyword found at the following URLs:\n");
+    print_ranked(graph, results, count);
+    free(results);
+}
+
+// Function to run a phrase (window 0) or proximity query and print the matching URLs by rank
+void search_index(inverted_index *idx, link_graph *graph, char *query, int window) {
+    unsigned *docs;
+    int count = index_search(idx, query, window, &docs);
+
+    if (count == 0) {
+        printf("No pages found\n");
+    } else {
+        ranked_url *results = (ranked_url *)malloc(count * sizeof(ranked_url));
+        for (int i = 0; i < count; i++) {
+            results[i].url = index_doc_url(idx, docs[i]);
+        }
+        printf("Found on the following URLs:\n");
+        print_ranked(graph, results, count);
+        free(results);
+    }
+    free(docs);
+}
+
+// Function to measure every subsystem against the memory budget
+void account_memory(memory_budget *m, arena *visited, trie *t, frontier *f, inverted_index *idx, link_graph *graph,
+                    robots_cache *robots, output_writer *writer, size_t fetch_bytes) {
+    memory_set(m, MEM_VISITED, visited->reserved);
+    memory_set(m, MEM_FRONTIER, f ? frontier_memory(f) : 0);
+    memory_set(m, MEM_KEYWORDS, t->pool.reserved);
+    memory_set(m, MEM_BODY_INDEX, index_memory(idx));
+    memory_set(m, MEM_GRAPH, graph_memory(graph));
+    memory_set(m, MEM_ROBOTS, robots->bytes);
+    memory_set(m, MEM_FETCH, fetch_bytes);
+    memory_set(m, MEM_OUTPUT, output_memory(writer));
+}
+
+// Function to sum the per-page fetch buffers: response, headers, output record and the scratch arena
+size_t fetch_memory(const ResponseData *response, const ResponseData *headers, const page_record *record, const arena *scratch) {
+    return response->capacity + headers->capacity + record->capacity + scratch->reserved;
+}
+
+// Function to apply backpressure when memory runs short; returns 0 if the crawl must stop to stay within the budget
+int relieve_memory(memory_budget *m, frontier *f, inverted_index *idx, ResponseData *response, const ResponseData *headers,
+                   const page_record *record, arena *scratch) {
+    int level = memory_pressure(m);
+    if (level != m->level) {
+        printf("Memory pressure %s: %zu KB of %zu KB\n", level == MEMORY_OK ? "cleared" : level == MEMORY_SOFT ? "high" : "at the limit",
+               m->total / 1024, m->limit / 1024);
+        m->level = level;
+    }
+
+    f->throttled = level != MEMORY_OK; // New links wait on disk while memory is short
+    if (level == MEMORY_OK) return 1;
+    m->throttled_pages++;
+
+    // Move the least valuable half of the frontier to disk
+    if (frontier_spillable(f) >= m->limit / 16 && frontier_spill(f, f->count / 2) > 0) {
+        m->frontier_spills++;
+        memory_set(m, MEM_FRONTIER, frontier_memory(f));
+    }
+
+    // Write the buffered postings out as a segment instead of waiting for the index's own budget
+    if (idx->buffered + idx->pool.used >= m->limit / 16) {
+        index_flush(idx);
+        m->index_flushes++;
+        memory_set(m, MEM_BODY_INDEX, index_memory(idx));
+    }
+
+    // Shrink the fetch buffers grown by large pages back to their initial size
+    if (response->capacity > 16384) {
+        char *data = (char *)realloc(response->data, 16384);
+        if (data) {
+            response->data = data;
+            response->capacity = 16384;
+        }
+    }
+    arena_free(scratch);
+    memory_set(m, MEM_FETCH, fetch_memory(response, headers, record, scratch));
+
+    return memory_pressure(m) != MEMORY_HARD;
+}
+
 // Main function to initiate the web crawler
 int main(int argc, char **argv) {
+    // Optional "-m <MB>" sets the memory budget
+    size_t budget_mb = MEMORY_DEFAULT_MB;
+    int arg = 1;
+    if (argc > 2 && strcmp(argv[1], "-m") == 0) {
+        budget_mb = strtoul(argv[2], NULL, 10);
+        arg = 3;
+    }
+    if (argc <= arg || budget_mb == 0) {
+        fprintf(stderr, "Usage: %s [-m budget_mb] maxdepth seed_url...\n", argv[0]);
+        return 1;
+    }
+
+    memory_budget budget;
+    memory_init(&budget, budget_mb * 1024 * 1024); // Account every subsystem against the budget
+
+    arena visited_pool;
+    arena_init(&visited_pool, 0); // Long-lived arena for the visited URL set
+
+    arena scratch;
+    arena_init(&scratch, 0); // Per-page arena for parsing temporaries, reset after each document
+
     HashMap hashmap;
-    init_hashmap(&hashmap); // Initialize hashmap
+    init_hashmap_arena(&hashmap, &visited_pool); // Initialize hashmap
     
     trie t;
     init_trie(&t); // Initialize trie
 
+    robots_cache robots;
+    robots_init(&robots); // Initialize the per-host robots.txt cache
+
+    inverted_index body_index;
+    size_t index_budget = budget.limit / 8 < INDEX_BUFFER_BYTES ? budget.limit / 8 : INDEX_BUFFER_BYTES;
+    index_init(&body_index, "crawl_index", index_budget); // Initialize the positional index of page bodies
+
+    output_writer writer;
+    size_t ring_bytes = OUTPUT_RING_BYTES;
+    while (ring_bytes > OUTPUT_MIN_RING_BYTES && ring_bytes > budget.limit / 16) ring_bytes /= 2; // Keep the ring a power of two
+    size_t batch_bytes = ring_bytes / 8 < OUTPUT_BATCH_BYTES ? ring_bytes / 8 : OUTPUT_BATCH_BYTES;
+    output_start(&writer, "crawl_output", ring_bytes, batch_bytes); // Start the thread writing page records to compressed segments
+    page_record record = { NULL, 0, 0, 0 }; // Encoded record of the current page, reused across pages
+
+    link_graph graph;
+    size_t edge_budget = budget.limit / 16 / sizeof(uint64_t);
+    graph_init(&graph, "crawl_graph", edge_budget < GRAPH_EDGE_BUFFER ? edge_budget : GRAPH_EDGE_BUFFER); // Initialize the link graph, spilled to disk as it grows
+
     CURL *curl;
     ResponseData response;
-    response.data = (char *)malloc(1); // Initialize response buffer
+    response.capacity = 16384;
+    response.data = (char *)malloc(response.capacity); // Initialize response buffer, reused for every page
+    response.data[0] = '\0';
     response.size = 0;
+    ResponseData headers;
+    headers.capacity = 4096;
+    headers.data = (char *)malloc(headers.capacity); // Initialize header buffer, reused for every page
+    headers.size = 0;
     curl = curl_easy_init(); // Initialize CURL library
     
-    int maxdepth = atoi(argv[1]); // Set maximum crawling depth from input
+    int maxdepth = atoi(argv[arg]); // Set maximum crawling depth from input
+    int within_budget = 1; // Cleared when backpressure cannot keep the crawl under the memory budget
 
     // Process each seed URL
-    for (int i = 2; i < argc; i++) {
+    for (int i = arg + 1; i < argc && within_budget; i++) {
         char *seed_url = argv[i];
         int depth = 0;
         printf("\nThe current seed URL is: %s\n", seed_url);
         
+        if (!robots_allowed(&robots, seed_url)) {
+            printf("Seed URL disallowed by robots.txt\n");
+            continue;
+        }
+
         if (curl) {
-            gethtml(curl, seed_url, &response); // Fetch HTML content
+            robots_wait(&robots, seed_url); // Honor the host's Crawl-delay
+            long status = gethtml(curl, seed_url, &response, &headers); // Fetch HTML content
+            record_begin(&record, seed_url, status, headers.data, headers.size); // Start the page's output record
             
-            queue q;
-            qinit(&q); // Initialize the queue
+            frontier f;
+            frontier_init(&f, maxdepth, NULL); // Initialize the frontier with the default scoring policy
+            frontier_enable_spill(&f, "crawl_frontier.spill"); // Let low-priority URLs move to disk under memory pressure
+            add_title_focus(&f, response.data); // Prefer links whose anchor text matches the seed's title
             printf("\nCurrent depth level: %d\n\n", depth);
-            find_links(seed_url, response.data, &hashmap, &q, 0); // Extract links
-            get_keywords(&t, response.data, seed_url); // Extract keywords
-            
-            free(response.data);
-            response.data = (char *)malloc(1);
-            response.size = 0;
+            find_links(seed_url, response.data, &hashmap, &f, &robots, &graph, &record, &scratch, 0); // Extract links
+            get_keywords(&t, response.data, seed_url, &record, &scratch); // Extract keywords
+            index_body(&body_index, response.data, seed_url, &scratch); // Index the body text
+            output_submit(&writer, &record); // Queue the record without waiting for the disk
 
-            node *q_node;
-            while ((q_node = dequeue(&q)) && q_node->depth <= maxdepth) {
-                if (depth < q_node->depth) {
-                    printf("\nVisiting depth level: %d\n", q_node->depth);
-                }
-                printf("\nVisiting link: %s\n", q_node->url);
-                gethtml(curl, q_node->url, &response); // Fetch HTML
-                find_links(q_node->url, response.data, &hashmap, &q, q_node->depth); // Extract links
-                get_keywords(&t, response.data, q_node->url); // Extract keywords
-
-                free(response.data);
-                response.data = (char *)malloc(1);
+            arena_reset(&scratch); // Drop the page's temporaries
+            response.data[0] = '\0';
+            response.size = 0;
+            account_memory(&budget, &visited_pool, &t, &f, &body_index, &graph, &robots, &writer,
+                           fetch_memory(&response, &headers, &record, &scratch));
+            within_budget = relieve_memory(&budget, &f, &body_index, &response, &headers, &record, &scratch); // Apply backpressure if needed
+
+            // Visit the most valuable URL first; nothing beyond maxdepth is ever queued
+            frontier_entry *entry;
+            while (within_budget && (entry = frontier_pop(&f)) != NULL) {
+                printf("\nVisiting link (depth %d): %s\n", entry->depth, entry->url);
+                robots_wait(&robots, entry->url); // Honor the host's Crawl-delay
+                status = gethtml(curl, entry->url, &response, &headers); // Fetch HTML
+                record_begin(&record, entry->url, status, headers.data, headers.size); // Start the page's output record
+                find_links(entry->url, response.data, &hashmap, &f, &robots, &graph, &record, &scratch, entry->depth); // Extract links
+                get_keywords(&t, response.data, entry->url, &record, &scratch); // Extract keywords
+                index_body(&body_index, response.data, entry->url, &scratch); // Index the body text
+                output_submit(&writer, &record); // Queue the record without waiting for the disk
+
+                arena_reset(&scratch); // Drop the page's temporaries
+                response.data[0] = '\0';
                 response.size = 0;
-                depth = q_node->depth;
-                free(q_node);
+                frontier_release(&f, entry);
+                account_memory(&budget, &visited_pool, &t, &f, &body_index, &graph, &robots, &writer,
+                               fetch_memory(&response, &headers, &record, &scratch));
+                within_budget = relieve_memory(&budget, &f, &body_index, &response, &headers, &record, &scratch); // Apply backpressure if needed
             }
+            frontier_free(&f); // Free the entries and their URLs
         } else {
             fprintf(stderr, "Failed to initialize CURL.\n");
         }
     }
 
+    if (!within_budget) {
+        printf("\nStopping early: the memory budget of %zu MB is exhausted\n", budget_mb);
+    }
     printf("\nCrawling complete!\n\n");
     curl_easy_cleanup(curl); // Cleanup CURL
+    robots_free(&robots); // Free the cached robots.txt rules
+    free(response.data);
+    free(headers.data);
+    record_free(&record);
+    output_stop(&writer); // Write the last records and stop the writer thread
+    printf("Page records: %llu written, %llu dropped, %llu truncated, %llu too large, %llu KB compressed to %llu KB\n",
+           writer.written, writer.dropped, writer.truncated, writer.oversized, writer.raw_bytes / 1024, writer.disk_bytes / 1024);
+    arena_free(&scratch);
+    index_finish(&body_index); // Flush and merge the index segments
+
+    graph_build(&graph); // Merge the edge runs into the in-link CSR
+    int iterations = graph_pagerank(&graph, 100, 0); // Rank pages on every CPU
+    printf("Link graph: %u pages, %llu links, PageRank after %d iterations\n",
+           graph.node_count, (unsigned long long)graph.csr_edges, iterations);
+
+    // Report memory per subsystem and the peak resident set size
+    account_memory(&budget, &visited_pool, &t, NULL, &body_index, &graph, &robots, &writer, 0);
+    memory_report(&budget, stdout);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("Peak RSS: %ld KB\n\n", usage.ru_maxrss);
 
     int choice = 1;
     char keyword[100];
+    char phrase[256];
+    int window;
 
     while (choice) {
         printf("Enter 1 to search for a keyword\n");
+        printf("Enter 2 to search page text for a phrase\n");
+        printf("Enter 3 to search page text for words near each other\n");
         printf("Enter 0 to exit\n");
         scanf("%d", &choice);
         
@@ -330,7 +575,19 @@ int main(int argc, char **argv) {
             case 1:
                 printf("Enter the keyword: ");
                 scanf("%s", keyword);
-                search_trie(&t, keyword); // Search for the keyword in the trie
+                search_keyword(&t, &graph, keyword); // Search for the keyword in the trie
+                break;
+            case 2:
+                printf("Enter the phrase: ");
+                scanf(" %255[^\n]", phrase);
+                search_index(&body_index, &graph, phrase, 0); // Exact phrase match
+                break;
+            case 3:
+                printf("Enter the words: ");
+                scanf(" %255[^\n]", phrase);
+                printf("Enter the maximum distance between them: ");
+                scanf("%d", &window);
+                search_index(&body_index, &graph, phrase, window > 0 ? window : 1); // All words within the window
                 break;
             case 0:
                 break;
@@ -340,6 +597,11 @@ int main(int argc, char **argv) {
         printf("\n");
     }
 
+    free_trie(&t);
+    index_free(&body_index);
+    graph_free(&graph);
+    free_hashmap(&hashmap);
+    arena_free(&visited_pool);
     return 0;
 }
 
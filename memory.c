@@ -0,0 +1,41 @@
+#include <string.h>
+#include "memory.h"
+
+// Start accounting against a budget of `limit` bytes
+void memory_init(memory_budget *m, size_t limit) {
+    memset(m, 0, sizeof(*m));
+    m->limit = limit;
+}
+
+// Record the current footprint of a subsystem and keep the totals and peaks in step
+void memory_set(memory_budget *m, int subsystem, size_t bytes) {
+    m->total = m->total - m->used[subsystem] + bytes;
+    m->used[subsystem] = bytes;
+    if (bytes > m->peak[subsystem]) m->peak[subsystem] = bytes;
+    if (m->total > m->peak_total) m->peak_total = m->total;
+}
+
+// Return the pressure level for the current total
+int memory_pressure(const memory_budget *m) {
+    if (m->total >= m->limit) return MEMORY_HARD;
+    if (m->total >= m->limit / 100 * MEMORY_SOFT_PERCENT) return MEMORY_SOFT;
+    return MEMORY_OK;
+}
+
+// Name of a subsystem for the stats output
+const char *memory_name(int subsystem) {
+    static const char *const names[MEM_SUBSYSTEMS] = {
+        "visited URLs", "frontier", "keyword trie", "body index", "link graph", "robots.txt", "fetch buffers", "output"
+    };
+    return subsystem >= 0 && subsystem < MEM_SUBSYSTEMS ? names[subsystem] : "unknown";
+}
+
+// Print current and peak usage per subsystem and the relief taken
+void memory_report(const memory_budget *m, FILE *out) {
+    fprintf(out, "Memory: %zu KB of %zu KB budget (peak %zu KB)\n", m->total / 1024, m->limit / 1024, m->peak_total / 1024);
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        fprintf(out, "  %-14s %10zu KB  (peak %zu KB)\n", memory_name(i), m->used[i] / 1024, m->peak[i] / 1024);
+    }
+    fprintf(out, "Backpressure: %llu frontier spills, %llu early index flushes, %llu throttled pages\n",
+            m->frontier_spills, m->index_flushes, m->throttled_pages);
+}
@@ -0,0 +1,47 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define MEMORY_DEFAULT_MB 1024    // Budget used when none is given on the command line
+#define MEMORY_SOFT_PERCENT 80    // Share of the budget at which backpressure starts
+
+// Pressure levels returned by memory_pressure
+#define MEMORY_OK 0      // Below the soft limit
+#define MEMORY_SOFT 1    // Above the soft limit: shed memory that can be moved to disk
+#define MEMORY_HARD 2    // At or above the budget: stop growing
+
+// Subsystems whose memory is accounted separately
+enum {
+    MEM_VISITED,     // Visited URL set
+    MEM_FRONTIER,    // URLs waiting to be fetched
+    MEM_KEYWORDS,    // Keyword trie
+    MEM_BODY_INDEX,  // Positional index buffers and dictionary
+    MEM_GRAPH,       // Link graph URL table, edge buffer and ranks
+    MEM_ROBOTS,      // Cached robots.txt rules
+    MEM_FETCH,       // Response, header and record buffers and the per-page arena
+    MEM_OUTPUT,      // Output ring and batch buffers
+    MEM_SUBSYSTEMS   // Number of subsystems
+};
+
+// Bytes held by each subsystem against a global budget
+typedef struct memory_budget {
+    size_t limit;                        // Budget in bytes
+    size_t used[MEM_SUBSYSTEMS];         // Current bytes of each subsystem
+    size_t peak[MEM_SUBSYSTEMS];         // Largest value seen for each subsystem
+    size_t total;                        // Sum of `used`
+    size_t peak_total;                   // Largest total seen
+    int level;                           // Pressure level the crawler last reacted to
+    unsigned long long frontier_spills;  // Times the frontier was spilled to disk
+    unsigned long long index_flushes;    // Times the index buffer was flushed early
+    unsigned long long throttled_pages;  // Pages crawled while new links went straight to disk
+} memory_budget;
+
+void memory_init(memory_budget *m, size_t limit); // Start accounting against a budget of `limit` bytes
+void memory_set(memory_budget *m, int subsystem, size_t bytes); // Record the current footprint of a subsystem
+int memory_pressure(const memory_budget *m); // Return MEMORY_OK, MEMORY_SOFT or MEMORY_HARD for the current total
+const char *memory_name(int subsystem); // Name of a subsystem for the stats output
+void memory_report(const memory_budget *m, FILE *out); // Print current and peak usage per subsystem and the relief taken
+
+#endif
@@ -0,0 +1,368 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include "output.h"
+
+#define OUTPUT_MAGIC "PGS1"  // First bytes of every segment file
+
+// Make room for `extra` more bytes in a record
+static void record_reserve(page_record *r, size_t extra) {
+    if (r->size + extra <= r->capacity) return;
+    size_t capacity = r->capacity ? r->capacity : 4096;
+    while (capacity < r->size + extra) capacity *= 2;
+    r->data = (unsigned char *)realloc(r->data, capacity);
+    r->capacity = capacity;
+}
+
+// Append a value as a varint: seven bits per byte, high bit set on all but the last
+static void record_varint(page_record *r, uint64_t value) {
+    record_reserve(r, 10);
+    while (value >= 0x80) {
+        r->data[r->size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    r->data[r->size++] = (unsigned char)value;
+}
+
+// Append a varint length followed by the bytes
+static void record_string(page_record *r, const char *text, size_t length) {
+    record_varint(r, length);
+    record_reserve(r, length);
+    memcpy(r->data + r->size, text, length);
+    r->size += length;
+}
+
+// Start a record for a fetched page
+void record_begin(page_record *r, const char *url, long status, const char *headers, size_t headers_length) {
+    r->size = 0;
+    record_string(r, url, strlen(url));
+    record_varint(r, status > 0 ? (uint64_t)status : 0);
+    record_string(r, headers, headers_length);
+    r->fixed = r->size;
+}
+
+// Append a tagged link or keyword to the record
+void record_add(page_record *r, char tag, const char *text, size_t length) {
+    record_reserve(r, 1);
+    r->data[r->size++] = (unsigned char)tag;
+    record_string(r, text, length);
+}
+
+// Free the record buffer
+void record_free(page_record *r) {
+    free(r->data);
+    r->data = NULL;
+    r->size = r->capacity = r->fixed = 0;
+}
+
+// Store a 32-bit value little-endian
+static void put_u32(unsigned char *p, uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+// Copy bytes into the ring at a free-running position, wrapping at the end
+static void ring_write(output_writer *w, uint64_t pos, const void *src, size_t length) {
+    size_t at = pos & (w->ring_size - 1);
+    size_t first = length < w->ring_size - at ? length : w->ring_size - at;
+    memcpy(w->ring + at, src, first);
+    memcpy(w->ring, (const unsigned char *)src + first, length - first);
+}
+
+// Copy bytes out of the ring at a free-running position, wrapping at the end
+static void ring_read(output_writer *w, uint64_t pos, void *dst, size_t length) {
+    size_t at = pos & (w->ring_size - 1);
+    size_t first = length < w->ring_size - at ? length : w->ring_size - at;
+    memcpy(dst, w->ring + at, first);
+    memcpy((unsigned char *)dst + first, w->ring, length - first);
+}
+
+// Length of the record prefix that fits in `limit` bytes together with an OUTPUT_TRUNCATED item, cut
+// at an item boundary; 0 if even the URL, status and headers do not fit
+static size_t truncate_length(const page_record *r, size_t limit) {
+    if (r->fixed + 2 > limit) return 0;
+
+    size_t end = r->fixed;
+    size_t pos = r->fixed;
+    while (pos < r->size) {
+        // Each item is a tag, a varint length and the bytes
+        uint64_t length = 0;
+        size_t next = pos + 1;
+        for (int shift = 0; next < r->size; shift += 7) {
+            unsigned char byte = r->data[next++];
+            length |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        next += length;
+        if (next + 2 > limit) break;
+        end = pos = next;
+    }
+    return end;
+}
+
+// Hand a record to the writer; never blocks, a full ring drops the record instead
+int output_submit(output_writer *w, const page_record *r) {
+    if (!w->ring) return 0;
+
+    // A record larger than a quarter of the ring would rarely find room: keep its leading items and mark it
+    static const unsigned char marker[2] = { OUTPUT_TRUNCATED, 0 };
+    size_t size = r->size, cut = 0;
+    if (4 + size > w->ring_size / 4) {
+        cut = truncate_length(r, w->ring_size / 4 - 4);
+        if (cut == 0) {
+            w->oversized++;
+            return 0;
+        }
+        size = cut + sizeof(marker);
+    }
+
+    uint64_t head = atomic_load_explicit(&w->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&w->tail, memory_order_acquire);
+    if (head - tail + 4 + size > w->ring_size) {
+        w->dropped++;
+        return 0;
+    }
+
+    unsigned char prefix[4];
+    put_u32(prefix, (uint32_t)size);
+    ring_write(w, head, prefix, 4);
+    if (cut) {
+        ring_write(w, head + 4, r->data, cut);
+        ring_write(w, head + 4 + cut, marker, sizeof(marker));
+        w->truncated++;
+    } else {
+        ring_write(w, head + 4, r->data, size);
+    }
+    atomic_store(&w->head, head + 4 + size);  // Publish the bytes to the writer
+
+    // Wake the writer only if it went to sleep on an empty ring
+    if (atomic_load(&w->sleeping)) {
+        pthread_mutex_lock(&w->lock);
+        pthread_cond_signal(&w->wake);
+        pthread_mutex_unlock(&w->lock);
+    }
+    w->submitted++;
+    return 1;
+}
+
+// Write a whole buffer, retrying short writes
+static int write_all(int fd, const unsigned char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+// Start a new segment file
+static void open_segment(output_writer *w) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/pages-%05d.seg", w->dir, w->segment_count++);
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) {
+        fprintf(stderr, "Cannot write output segment %s\n", path);
+        return;
+    }
+    write_all(w->fd, (const unsigned char *)OUTPUT_MAGIC, 4);
+    w->segment_bytes = 4;
+}
+
+// Compress the batch into one block and append it to the current segment with a single write
+static void flush_batch(output_writer *w) {
+    if (w->batch_size == 0) return;
+
+    uLongf compressed = compressBound(w->batch_size);
+    if (8 + compressed > w->block_capacity) {
+        w->block_capacity = 8 + compressed;
+        w->block = (unsigned char *)realloc(w->block, w->block_capacity);
+    }
+    if (compress2(w->block + 8, &compressed, w->batch, w->batch_size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        fprintf(stderr, "Cannot compress output block\n");
+        w->batch_size = 0;
+        w->batch_records = 0;
+        return;
+    }
+
+    // Block header: uncompressed and compressed lengths
+    put_u32(w->block, (uint32_t)w->batch_size);
+    put_u32(w->block + 4, (uint32_t)compressed);
+
+    if (w->fd < 0 || w->segment_bytes >= OUTPUT_SEGMENT_BYTES) {
+        if (w->fd >= 0) close(w->fd);
+        open_segment(w);
+    }
+    if (w->fd >= 0 && write_all(w->fd, w->block, 8 + compressed)) {
+        w->segment_bytes += 8 + compressed;
+        w->raw_bytes += w->batch_size;
+        w->disk_bytes += 8 + compressed;
+        w->written += w->batch_records;
+    } else {
+        fprintf(stderr, "Cannot write output block\n");
+    }
+    w->batch_size = 0;
+    w->batch_records = 0;
+}
+
+// Current time on the monotonic clock
+static struct timespec monotonic_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now;
+}
+
+// Wait until records arrive, stop is requested or, with a partial batch, its flush deadline passes
+static void wait_for_records(output_writer *w, uint64_t tail, const struct timespec *deadline) {
+    pthread_mutex_lock(&w->lock);
+    atomic_store(&w->sleeping, 1);  // Announce the wait before the last look at the ring
+    if (atomic_load(&w->head) == tail && !atomic_load(&w->stop)) {
+        if (deadline) {
+            pthread_cond_timedwait(&w->wake, &w->lock, deadline);
+        } else {
+            pthread_cond_wait(&w->wake, &w->lock);
+        }
+    }
+    atomic_store(&w->sleeping, 0);
+    pthread_mutex_unlock(&w->lock);
+}
+
+// Writer thread: move records from the ring into the batch and flush full or idle batches
+static void *writer_thread(void *arg) {
+    output_writer *w = (output_writer *)arg;
+    uint64_t tail = atomic_load_explicit(&w->tail, memory_order_relaxed);
+    struct timespec last_record = monotonic_now();  // When the ring was last drained
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&w->head, memory_order_acquire);
+
+        if (tail == head) {
+            if (atomic_load_explicit(&w->stop, memory_order_acquire)) {
+                // Stop was requested; exit once a final look finds the ring still empty
+                if (atomic_load_explicit(&w->head, memory_order_acquire) == tail) break;
+                continue;
+            }
+
+            // A partial batch is flushed once the ring has been idle for OUTPUT_FLUSH_MS
+            struct timespec deadline = last_record;
+            deadline.tv_sec += OUTPUT_FLUSH_MS / 1000;
+            deadline.tv_nsec += (OUTPUT_FLUSH_MS % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            struct timespec now = monotonic_now();
+            if (w->batch_size > 0 && (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec))) {
+                flush_batch(w);
+            }
+            wait_for_records(w, tail, w->batch_size > 0 ? &deadline : NULL);
+            continue;
+        }
+
+        // Drain everything published so far
+        while (tail != head) {
+            unsigned char prefix[4];
+            ring_read(w, tail, prefix, 4);
+            size_t length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) | ((size_t)prefix[3] << 24);
+
+            if (w->batch_size + 4 + length > w->batch_capacity) {
+                flush_batch(w);
+                if (4 + length > w->batch_capacity) {
+                    w->batch_capacity = 4 + length;
+                    w->batch = (unsigned char *)realloc(w->batch, w->batch_capacity);
+                }
+            }
+            memcpy(w->batch + w->batch_size, prefix, 4);
+            ring_read(w, tail + 4, w->batch + w->batch_size + 4, length);
+            w->batch_size += 4 + length;
+            w->batch_records++;
+            tail += 4 + length;
+        }
+        atomic_store_explicit(&w->tail, tail, memory_order_release);  // Hand the space back to the crawler
+        last_record = monotonic_now();
+
+        if (w->batch_size >= w->batch_limit) flush_batch(w);
+    }
+
+    flush_batch(w);
+    if (w->fd >= 0) close(w->fd);
+    w->fd = -1;
+    return NULL;
+}
+
+// Start the writer thread
+int output_start(output_writer *w, const char *dir, size_t ring_bytes, size_t batch_bytes) {
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create output directory %s\n", dir);
+        return 0;
+    }
+
+    w->dir = strdup(dir);
+    w->ring_size = ring_bytes;
+    w->ring = (unsigned char *)malloc(w->ring_size);
+    w->batch_limit = batch_bytes;
+    w->batch_capacity = batch_bytes + batch_bytes / 16;  // Room for the record that crosses the threshold
+    w->batch = (unsigned char *)malloc(w->batch_capacity);
+    atomic_init(&w->head, 0);
+    atomic_init(&w->tail, 0);
+    atomic_init(&w->stop, 0);
+    atomic_init(&w->sleeping, 0);
+
+    // The flush deadline is measured on the monotonic clock, so the condition variable must use it too
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&w->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&w->lock, NULL);
+
+    if (pthread_create(&w->thread, NULL, writer_thread, w) != 0) {
+        fprintf(stderr, "Cannot start the output writer\n");
+        pthread_cond_destroy(&w->wake);
+        pthread_mutex_destroy(&w->lock);
+        free(w->ring);
+        w->ring = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// Bytes held by the ring and the writer's buffers; the batch and block sizes are the writer's steady state
+size_t output_memory(const output_writer *w) {
+    if (!w->ring) return 0;
+    size_t batch = w->batch_limit + w->batch_limit / 16;
+    return w->ring_size + batch + compressBound(batch) + 8;
+}
+
+// Drain the ring, write the last block and join the writer thread
+void output_stop(output_writer *w) {
+    if (w->ring) {
+        pthread_mutex_lock(&w->lock);
+        atomic_store(&w->stop, 1);
+        pthread_cond_signal(&w->wake);
+        pthread_mutex_unlock(&w->lock);
+        pthread_join(w->thread, NULL);
+        pthread_cond_destroy(&w->wake);
+        pthread_mutex_destroy(&w->lock);
+    }
+
+    free(w->ring);
+    free(w->batch);
+    free(w->block);
+    free(w->dir);
+    w->ring = w->batch = w->block = NULL;
+    w->dir = NULL;
+}
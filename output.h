@@ -0,0 +1,71 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define OUTPUT_RING_BYTES (8 * 1024 * 1024)       // Largest ring between the crawler and the writer, a power of two
+#define OUTPUT_MIN_RING_BYTES (64 * 1024)         // Smallest ring, used under tight memory budgets
+#define OUTPUT_BATCH_BYTES (1024 * 1024)          // Largest batch of records compressed and written as one block
+#define OUTPUT_SEGMENT_BYTES (64 * 1024 * 1024)   // Compressed bytes written to a segment before the next one is started
+#define OUTPUT_FLUSH_MS 500                       // An idle writer flushes a partial batch after this long
+
+// Item tags following the fixed fields of a page record
+#define OUTPUT_LINK 'L'      // A link extracted from the page
+#define OUTPUT_KEYWORD 'K'   // A keyword indexed for the page
+#define OUTPUT_TRUNCATED 'T' // Last item of a record cut short to fit the ring; its text is empty
+
+// A crawled page serialized as varint-prefixed fields: URL, HTTP status, headers, then tagged links and keywords
+typedef struct page_record {
+    unsigned char *data;  // Encoded record, reused across pages
+    size_t size;          // Bytes used
+    size_t capacity;      // Bytes allocated
+    size_t fixed;         // Bytes of the URL, status and headers, where the tagged items start
+} page_record;
+
+// Writer thread draining a single-producer, single-consumer ring into compressed segment files
+typedef struct output_writer {
+    char *dir;                     // Directory holding the segments
+    unsigned char *ring;           // Ring of length-prefixed records
+    size_t ring_size;              // Capacity of the ring
+    _Atomic uint64_t head;         // Bytes ever produced, advanced only by the crawler
+    _Atomic uint64_t tail;         // Bytes ever consumed, advanced only by the writer
+    atomic_int stop;               // Asks the writer to drain the ring and exit
+    atomic_int sleeping;           // Set while the writer waits for records; the crawler then signals `wake`
+    pthread_mutex_t lock;          // Guards the writer's wait on `wake`
+    pthread_cond_t wake;           // Signalled when records arrive for a sleeping writer or on stop
+
+    unsigned long long submitted;  // Records queued by the crawler
+    unsigned long long dropped;    // Records dropped because the ring was full
+    unsigned long long truncated;  // Records larger than a quarter of the ring, cut to fit at an item boundary
+    unsigned long long oversized;  // Records dropped because their URL and headers alone did not fit
+
+    size_t batch_limit;            // Batch size at which a block is compressed and written
+    unsigned char *batch;          // Records waiting to be compressed (writer only)
+    size_t batch_size;             // Bytes used in `batch`
+    unsigned batch_records;        // Records in `batch`
+    size_t batch_capacity;         // Bytes allocated for `batch`
+    unsigned char *block;          // Compressed block with its header (writer only)
+    size_t block_capacity;         // Bytes allocated for `block`
+    int fd;                        // Current segment file, -1 before the first block
+    int segment_count;             // Segments started
+    size_t segment_bytes;          // Bytes written to the current segment
+    unsigned long long written;    // Records whose block reached the disk
+    unsigned long long raw_bytes;  // Record bytes before compression
+    unsigned long long disk_bytes; // Bytes written to disk
+
+    pthread_t thread;              // The writer thread
+} output_writer;
+
+void record_begin(page_record *r, const char *url, long status, const char *headers, size_t headers_length); // Start a record for a fetched page
+void record_add(page_record *r, char tag, const char *text, size_t length); // Append a tagged link or keyword to the record
+void record_free(page_record *r); // Free the record buffer
+
+int output_start(output_writer *w, const char *dir, size_t ring_bytes, size_t batch_bytes); // Start the writer thread writing segments into `dir`; `ring_bytes` must be a power of two; returns 0 on failure
+int output_submit(output_writer *w, const page_record *r); // Hand a record to the writer without blocking, truncating one larger than a quarter of the ring; returns 0 if it was dropped
+size_t output_memory(const output_writer *w); // Bytes held by the ring and the writer's buffers
+void output_stop(output_writer *w); // Drain the ring, write the last block and join the writer thread
+
+#endif
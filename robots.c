@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include "robots.h"
+
+#define ROBOTS_MAX_SIZE (512 * 1024)  // Bytes of robots.txt that are parsed, the rest is ignored
+
+// Buffer used to receive a robots.txt body
+typedef struct {
+    char *data;   // Response data
+    size_t size;  // Size of the data
+} robots_buffer;
+
+// Callback used by CURL to store the robots.txt body, truncated to ROBOTS_MAX_SIZE
+static size_t robots_write(void *contents, size_t size, size_t nmemb, void *userdata) {
+    size_t total_size = size * nmemb;
+    robots_buffer *buf = (robots_buffer *)userdata;
+
+    // Silently drop anything past the size limit but report it as consumed
+    size_t room = ROBOTS_MAX_SIZE - buf->size;
+    size_t keep = total_size < room ? total_size : room;
+    if (keep == 0) return total_size;
+
+    char *new_data = realloc(buf->data, buf->size + keep + 1);
+    if (new_data == NULL) return 0;  // Abort the transfer if memory allocation fails
+
+    buf->data = new_data;
+    memcpy(buf->data + buf->size, contents, keep);
+    buf->size += keep;
+    buf->data[buf->size] = '\0';
+    return total_size;
+}
+
+// Split a URL into its "scheme://host" part and the path that follows; returns the host length or 0
+static size_t split_host(const char *url, const char **path) {
+    const char *scheme_end = strstr(url, "://");
+    if (!scheme_end) return 0;  // Relative or malformed URL, no host to look up
+
+    const char *p = scheme_end + 3;
+    while (*p && *p != '/' && *p != '?' && *p != '#') p++;  // Host ends at the first path delimiter
+
+    *path = p;
+    return (size_t)(p - url);
+}
+
+// FNV-1a hash of a host name span
+static unsigned long robots_hash(const char *host, size_t length) {
+    unsigned long hash = 2166136261UL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)tolower((unsigned char)host[i]);
+        hash *= 16777619UL;
+    }
+    return hash % ROBOTS_TABLE_SIZE;
+}
+
+// Free a rule trie recursively
+static void free_rules(robots_node *node) {
+    while (node) {
+        robots_node *next = node->sibling;
+        free_rules(node->child);
+        free(node);
+        node = next;
+    }
+}
+
+// Find or create the child of `parent` reached through byte `c`
+static robots_node *rule_child(robots_entry *entry, robots_node *parent, char c) {
+    robots_node *child;
+    for (child = parent->child; child; child = child->sibling) {
+        if (child->c == c) return child;
+    }
+
+    child = (robots_node *)calloc(1, sizeof(robots_node));
+    entry->rule_bytes += sizeof(robots_node);
+    child->id = entry->node_count++;
+    child->depth = parent->depth + 1;
+    child->c = c;
+    child->sibling = parent->child;
+    parent->child = child;
+    return child;
+}
+
+// Add one Allow/Disallow pattern to the rule trie
+static void add_rule(robots_entry *entry, const char *pattern, size_t length, unsigned char verdict) {
+    int anchored = 0;
+
+    // A trailing '$' anchors the pattern at the end of the path; trailing '*' is implied and dropped
+    if (length > 0 && pattern[length - 1] == '$') {
+        anchored = 1;
+        length--;
+    }
+    while (!anchored && length > 0 && pattern[length - 1] == '*') length--;
+
+    // robots.txt is untrusted: bound the number of wildcards a single rule may contain
+    size_t wildcards = 0;
+    for (size_t i = 0; i < length; i++) wildcards += pattern[i] == '*';
+    if (wildcards > ROBOTS_MAX_WILDCARDS) return;
+
+    if (!entry->rules) {
+        entry->rules = (robots_node *)calloc(1, sizeof(robots_node));
+        entry->rule_bytes += sizeof(robots_node);
+        entry->rules->id = entry->node_count++;
+    }
+
+    robots_node *node = entry->rules;
+    for (size_t i = 0; i < length; i++) {
+        if (pattern[i] == '*' && i > 0 && pattern[i - 1] == '*') continue;  // Collapse runs of '*'
+        node = rule_child(entry, node, pattern[i]);
+    }
+
+    // When the same pattern is listed as both Allow and Disallow, Allow wins
+    unsigned char *slot = anchored ? &node->rule_end : &node->rule;
+    if (*slot != ROBOTS_ALLOW) *slot = verdict;
+}
+
+// Keep a matching rule if it is longer than the best so far; on equal length Allow wins
+static void record_rule(unsigned char verdict, int depth, int *best_depth, unsigned char *best_rule) {
+    if (verdict == ROBOTS_NONE) return;
+    if (depth > *best_depth || (depth == *best_depth && verdict == ROBOTS_ALLOW)) {
+        *best_depth = depth;
+        *best_rule = verdict;
+    }
+}
+
+// Add a state to the next list unless it is already there; a node's '*' children are entered without consuming a byte
+static void add_state(const robots_entry *entry, const robots_node *node, const robots_node **list, unsigned *count) {
+    unsigned long bit = 1UL << (node->id % (8 * sizeof(unsigned long)));
+    unsigned long *word = &entry->active[node->id / (8 * sizeof(unsigned long))];
+    if (*word & bit) return;
+    *word |= bit;
+    list[(*count)++] = node;
+
+    for (const robots_node *child = node->child; child; child = child->sibling) {
+        if (child->c == '*') add_state(entry, child, list, count);
+    }
+}
+
+// Run the rule trie as an NFA over the path, recording the longest matching rule; time is O(states x path length)
+static void match_rules(const robots_entry *entry, const char *path, int *best_depth, unsigned char *best_rule) {
+    const robots_node **current = entry->states;
+    const robots_node **next = entry->states + entry->node_count;
+    unsigned current_count = 0, next_count;
+
+    add_state(entry, entry->rules, current, &current_count);
+    for (;; path++) {
+        // Every state reached so far ends a rule that matches a prefix of the path
+        for (unsigned i = 0; i < current_count; i++) {
+            entry->active[current[i]->id / (8 * sizeof(unsigned long))] = 0;  // Clear the bit set for the next step
+            record_rule(current[i]->rule, (int)current[i]->depth, best_depth, best_rule);
+            if (*path == '\0') record_rule(current[i]->rule_end, (int)current[i]->depth, best_depth, best_rule);
+        }
+        if (*path == '\0' || current_count == 0) return;
+
+        // Step every state over the next byte; a wildcard state also stays where it is
+        next_count = 0;
+        for (unsigned i = 0; i < current_count; i++) {
+            const robots_node *node = current[i];
+            if (node->c == '*') add_state(entry, node, next, &next_count);
+            for (const robots_node *child = node->child; child; child = child->sibling) {
+                if (child->c != '*' && child->c == *path) add_state(entry, child, next, &next_count);
+            }
+        }
+
+        const robots_node **swap = current;
+        current = next;
+        next = swap;
+        current_count = next_count;
+    }
+}
+
+// Check a path against a compiled entry; returns 1 if allowed and 0 if disallowed
+int robots_match(const robots_entry *entry, const char *path) {
+    if (entry->disallow_all) return 0;
+    if (!entry->rules) return 1;  // No rules, everything is allowed
+
+    if (*path != '/') path = "/";  // An empty path is the site root
+
+    int best_depth = -1;
+    unsigned char best_rule = ROBOTS_NONE;
+    match_rules(entry, path, &best_depth, &best_rule);
+
+    return best_rule != ROBOTS_DISALLOW;
+}
+
+// Case-insensitive check of a "field:" prefix; returns a pointer to the trimmed value or NULL
+static const char *field_value(const char *line, const char *field) {
+    size_t field_length = strlen(field);
+    if (strncasecmp(line, field, field_length) != 0) return NULL;
+
+    const char *p = line + field_length;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != ':') return NULL;
+
+    p++;
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+// Check whether a User-agent value names this crawler
+static int agent_matches(const char *value, size_t length) {
+    size_t agent_length = strlen(ROBOTS_AGENT);
+    return length == agent_length && strncasecmp(value, ROBOTS_AGENT, agent_length) == 0;
+}
+
+// Parse robots.txt contents, keeping the rules of the group for ROBOTS_AGENT or else the '*' group
+static void parse_groups(robots_entry *entry, const char *txt, int want_specific) {
+    int in_agents = 0;   // Currently reading a run of User-agent lines
+    int applies = 0;     // The current group applies to this crawler
+    char line[2048];
+
+    const char *pos = txt;
+    while (*pos) {
+        // Copy the next line, dropping comments and trailing whitespace
+        size_t n = 0;
+        while (*pos && *pos != '\n' && *pos != '\r') {
+            if (n < sizeof(line) - 1) line[n++] = *pos;
+            pos++;
+        }
+        while (*pos == '\n' || *pos == '\r') pos++;
+        line[n] = '\0';
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        n = strlen(line);
+        while (n > 0 && isspace((unsigned char)line[n - 1])) line[--n] = '\0';
+
+        const char *start = line;
+        while (*start == ' ' || *start == '\t') start++;
+        if (*start == '\0') continue;
+
+        const char *value;
+        if ((value = field_value(start, "user-agent"))) {
+            if (!in_agents) applies = 0;  // A new group starts
+            in_agents = 1;
+            size_t length = strlen(value);
+            if (want_specific ? agent_matches(value, length) : strcmp(value, "*") == 0) applies = 1;
+            continue;
+        }
+        in_agents = 0;
+        if (!applies) continue;
+
+        if ((value = field_value(start, "disallow"))) {
+            if (*value) add_rule(entry, value, strlen(value), ROBOTS_DISALLOW);
+        } else if ((value = field_value(start, "allow"))) {
+            if (*value) add_rule(entry, value, strlen(value), ROBOTS_ALLOW);
+        } else if ((value = field_value(start, "crawl-delay"))) {
+            // The value is untrusted: ignore anything that is not a finite number and cap the rest
+            double delay = strtod(value, NULL);
+            if (!isfinite(delay)) continue;
+            if (delay > ROBOTS_MAX_CRAWL_DELAY) delay = ROBOTS_MAX_CRAWL_DELAY;
+            if (delay > entry->crawl_delay) entry->crawl_delay = delay;
+        }
+    }
+}
+
+// Check whether any User-agent line of robots.txt names this crawler
+static int has_specific_group(const char *txt) {
+    const char *pos = txt;
+    while (*pos) {
+        while (*pos == ' ' || *pos == '\t') pos++;  // Skip indentation at the start of the line
+
+        const char *value = field_value(pos, "user-agent");
+        if (value && agent_matches(value, strcspn(value, " \t\r\n#"))) return 1;
+
+        pos += strcspn(pos, "\n");  // Move to the next line
+        if (*pos) pos++;
+    }
+    return 0;
+}
+
+// Compile robots.txt contents into the entry's matcher, replacing any previous rules
+void robots_compile(robots_entry *entry, const char *txt) {
+    free_rules(entry->rules);
+    free(entry->states);
+    free(entry->active);
+    entry->rules = NULL;
+    entry->states = NULL;
+    entry->active = NULL;
+    entry->rule_bytes = 0;
+    entry->node_count = 0;
+    entry->crawl_delay = 0;
+    entry->disallow_all = 0;
+
+    parse_groups(entry, txt, has_specific_group(txt));
+
+    // Work space of the matcher: two state lists and a bit set, sized once per compile
+    if (entry->rules) {
+        size_t words = entry->node_count / (8 * sizeof(unsigned long)) + 1;
+        entry->states = (const robots_node **)malloc(2 * entry->node_count * sizeof(robots_node *));
+        entry->active = (unsigned long *)calloc(words, sizeof(unsigned long));
+        entry->rule_bytes += 2 * entry->node_count * sizeof(robots_node *) + words * sizeof(unsigned long);
+    }
+}
+
+// Fetch robots.txt for an entry's host and compile it
+static void robots_fetch(robots_cache *cache, robots_entry *entry) {
+    robots_buffer buf = { NULL, 0 };
+    char robots_url[512];
+    snprintf(robots_url, sizeof(robots_url), "%s/robots.txt", entry->host);
+
+    long status = 0;
+    CURLcode res = CURLE_WRITE_ERROR;
+    if (cache->curl) {
+        curl_easy_setopt(cache->curl, CURLOPT_URL, robots_url);
+        curl_easy_setopt(cache->curl, CURLOPT_WRITEFUNCTION, robots_write);
+        curl_easy_setopt(cache->curl, CURLOPT_WRITEDATA, (void *)&buf);
+        curl_easy_setopt(cache->curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(cache->curl, CURLOPT_USERAGENT, ROBOTS_AGENT);
+        curl_easy_setopt(cache->curl, CURLOPT_TIMEOUT, 10L);
+        res = curl_easy_perform(cache->curl);
+        if (res == CURLE_OK) curl_easy_getinfo(cache->curl, CURLINFO_RESPONSE_CODE, &status);
+    }
+
+    if (res == CURLE_OK && status >= 200 && status < 300) {
+        robots_compile(entry, buf.data ? buf.data : "");
+    } else {
+        // A missing robots.txt (4xx) allows everything; an unreachable one (5xx) disallows everything
+        robots_compile(entry, "");
+        entry->disallow_all = (res == CURLE_OK && status >= 500);
+    }
+    entry->fetched_at = time(NULL);
+
+    free(buf.data);
+}
+
+// Initialize an empty cache and its CURL handle
+void robots_init(robots_cache *cache) {
+    for (int i = 0; i < ROBOTS_TABLE_SIZE; i++) {
+        cache->table[i] = NULL;
+    }
+    cache->bytes = 0;
+    cache->curl = curl_easy_init();
+}
+
+// Free every cached entry and the CURL handle
+void robots_free(robots_cache *cache) {
+    for (int i = 0; i < ROBOTS_TABLE_SIZE; i++) {
+        robots_entry *entry = cache->table[i];
+        while (entry) {
+            robots_entry *next = entry->next;
+            free_rules(entry->rules);
+            free(entry->states);
+            free(entry->active);
+            free(entry->host);
+            free(entry);
+            entry = next;
+        }
+        cache->table[i] = NULL;
+    }
+    cache->bytes = 0;
+    if (cache->curl) curl_easy_cleanup(cache->curl);
+    cache->curl = NULL;
+}
+
+// Return the entry for the URL's host, fetching robots.txt when it is missing or older than ROBOTS_TTL
+robots_entry *robots_lookup(robots_cache *cache, const char *url) {
+    const char *path;
+    size_t host_length = split_host(url, &path);
+    if (host_length == 0) return NULL;
+
+    unsigned long index = robots_hash(url, host_length);
+    robots_entry *entry;
+    for (entry = cache->table[index]; entry; entry = entry->next) {
+        if (strlen(entry->host) == host_length && strncasecmp(entry->host, url, host_length) == 0) break;
+    }
+
+    if (!entry) {
+        entry = (robots_entry *)calloc(1, sizeof(robots_entry));
+        entry->host = strndup(url, host_length);
+        entry->next = cache->table[index];
+        cache->table[index] = entry;
+        robots_fetch(cache, entry);
+        cache->bytes += sizeof(robots_entry) + host_length + 1 + entry->rule_bytes;
+    } else if (time(NULL) - entry->fetched_at > ROBOTS_TTL) {
+        size_t old_bytes = entry->rule_bytes;
+        robots_fetch(cache, entry);  // Refresh a stale entry
+        cache->bytes += entry->rule_bytes - old_bytes;
+    }
+    return entry;
+}
+
+// Return 1 if the URL may be crawled according to its host's robots.txt
+int robots_allowed(robots_cache *cache, const char *url) {
+    robots_entry *entry = robots_lookup(cache, url);
+    if (!entry) return 1;  // URLs without a host are not covered by robots.txt
+
+    const char *path;
+    split_host(url, &path);
+    return robots_match(entry, path);
+}
+
+// Sleep until the host's Crawl-delay has elapsed since its previous request
+void robots_wait(robots_cache *cache, const char *url) {
+    robots_entry *entry = robots_lookup(cache, url);
+    if (!entry) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (entry->crawl_delay > 0 && (entry->last_access.tv_sec || entry->last_access.tv_nsec)) {
+        double elapsed = (now.tv_sec - entry->last_access.tv_sec) + (now.tv_nsec - entry->last_access.tv_nsec) / 1e9;
+        double remaining = entry->crawl_delay - elapsed;
+        if (remaining > 0) {
+            struct timespec pause;
+            pause.tv_sec = (time_t)remaining;
+            pause.tv_nsec = (long)((remaining - pause.tv_sec) * 1e9);
+            nanosleep(&pause, NULL);
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        }
+    }
+    entry->last_access = now;
+}
@@ -0,0 +1,60 @@
+#ifndef ROBOTS_H
+#define ROBOTS_H
+
+#include <stddef.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#define ROBOTS_TABLE_SIZE 256          // Number of buckets in the per-host robots cache
+#define ROBOTS_TTL (24 * 60 * 60)      // Seconds a fetched robots.txt stays valid
+#define ROBOTS_AGENT "webcrawler"      // Product token matched against User-agent lines
+#define ROBOTS_MAX_WILDCARDS 16        // Rules with more '*' than this are ignored
+#define ROBOTS_MAX_CRAWL_DELAY 60.0    // Longest Crawl-delay honored, in seconds; the wait blocks the whole crawl
+
+// Rule verdicts stored in the compiled matcher
+#define ROBOTS_NONE 0
+#define ROBOTS_ALLOW 1
+#define ROBOTS_DISALLOW 2
+
+// Node of the compiled rule trie; each edge is one byte of a path pattern ('*' is a wildcard)
+typedef struct robots_node {
+    char c;                        // Pattern byte leading to this node
+    unsigned char rule;            // Verdict of a rule ending here (prefix match)
+    unsigned char rule_end;        // Verdict of a rule ending here with a trailing '$'
+    unsigned id;                   // Index of the node among its entry's nodes, used as an NFA state
+    unsigned depth;                // Pattern bytes from the root, the length of a rule ending here
+    struct robots_node *child;     // First child node
+    struct robots_node *sibling;   // Next node sharing the same parent
+} robots_node;
+
+// Cached robots.txt rules of a single host
+typedef struct robots_entry {
+    char *host;                    // Scheme and host, e.g. "https://example.com"
+    robots_node *rules;            // Root of the compiled rule trie (NULL if everything is allowed)
+    size_t rule_bytes;             // Memory held by the rule trie
+    unsigned node_count;           // Nodes in the rule trie
+    const robots_node **states;    // Matcher work space: current and next state lists, node_count each
+    unsigned long *active;         // Matcher work space: bit set of the states already in the next list
+    int disallow_all;              // Set when robots.txt could not be fetched due to a server error
+    double crawl_delay;            // Seconds to wait between requests to this host
+    time_t fetched_at;             // Time robots.txt was fetched, used for the TTL
+    struct timespec last_access;   // Time of the last request to this host, used for Crawl-delay
+    struct robots_entry *next;     // Next entry in the same bucket
+} robots_entry;
+
+// Cache of robots.txt rules keyed by host
+typedef struct robots_cache {
+    robots_entry *table[ROBOTS_TABLE_SIZE];  // Buckets of per-host entries
+    CURL *curl;                              // Dedicated handle used to fetch robots.txt files
+    size_t bytes;                            // Memory held by the entries and their rules
+} robots_cache;
+
+void robots_init(robots_cache *cache); // Initialize an empty cache and its CURL handle
+void robots_free(robots_cache *cache); // Free every cached entry and the CURL handle
+int robots_allowed(robots_cache *cache, const char *url); // Return 1 if the URL may be crawled, fetching robots.txt if needed
+void robots_wait(robots_cache *cache, const char *url); // Sleep until the host's Crawl-delay has elapsed
+robots_entry *robots_lookup(robots_cache *cache, const char *url); // Return the fresh entry for the URL's host, fetching it if needed
+void robots_compile(robots_entry *entry, const char *txt); // Compile robots.txt contents into the entry's matcher
+int robots_match(const robots_entry *entry, const char *path); // Check a path against a compiled entry
+
+#endif
@@ -10,14 +10,21 @@ void init_SLL(SLL *lp) {
 }
 
 // Function to append a new node to the end of the singly linked list
-void append(SLL* lp, char *url) {
-    
-    // Allocate memory for a new node
-    sll_node* nn = (sll_node*) malloc(sizeof(sll_node));
-    
-    // Allocate memory for the URL string and copy the provided URL into the node
-    nn->url = (char*)malloc(strlen(url) + 1);
-    strcpy(nn -> url, url);
+void append(SLL* lp, char *url, arena *pool) {
+    sll_node* nn;
+
+    if (pool) {
+        // Bump-allocate the node and a copy of the URL from the arena
+        nn = (sll_node*) arena_alloc(pool, sizeof(sll_node));
+        nn->url = arena_strdup(pool, url);
+    } else {
+        // Allocate memory for a new node
+        nn = (sll_node*) malloc(sizeof(sll_node));
+
+        // Allocate memory for the URL string and copy the provided URL into the node
+        nn->url = (char*)malloc(strlen(url) + 1);
+        strcpy(nn -> url, url);
+    }
     
     // Set the `next` pointer of the new node to NULL
     nn -> next = NULL;
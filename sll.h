@@ -1,3 +1,8 @@
+#ifndef SLL_H
+#define SLL_H
+
+#include "arena.h"
+
 // Define a structure for a node in the singly linked list
 typedef struct sll_node {
     char *url;              // A string to store the URL
@@ -8,7 +13,7 @@ typedef struct sll_node {
 typedef sll_node* SLL;  // SLL is a pointer to the head node (first element) of the linked list
 
 void init_SLL(SLL *lp); // Function to initialize the singly linked list by setting its head to NULL
-void append(SLL* lp, char *url); // Function to append a new node with the specified URL to the end of the list
+void append(SLL* lp, char *url, arena *pool); // Function to append a new node with the specified URL to the end of the list (heap-allocated if pool is NULL)
 int len(SLL l); // Function to calculate and return the length (number of nodes) of the singly linked list
 
-
+#endif
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "text.h"
+
+// Check whether `p` opens (or, with `closing` set, closes) the tag `name`
+static int tag_is(const char *p, const char *name, int closing) {
+    size_t name_length = strlen(name);
+    if (*p++ != '<') return 0;
+    if (closing && *p++ != '/') return 0;
+    if (strncasecmp(p, name, name_length) != 0) return 0;
+
+    char next = p[name_length];
+    return next == '>' || next == '/' || next == ' ' || next == '\t' || next == '\n' || next == '\r';
+}
+
+// Return the name of the element opened at `p` if its content is not visible text, or NULL
+static const char *raw_text_element(const char *p) {
+    static const char *const names[] = { "script", "style", "noscript", "template" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (tag_is(p, names[i], 0)) return names[i];
+    }
+    return NULL;
+}
+
+// Return the position just past the closing tag of a raw-text element, or the end of the string
+static const char *skip_element(const char *p, const char *name) {
+    while ((p = strchr(p + 1, '<')) != NULL) {
+        if (tag_is(p, name, 1)) {
+            const char *close = strchr(p, '>');
+            return close ? close + 1 : p + strlen(p);
+        }
+    }
+    return NULL;
+}
+
+// Append a code point to `out` as UTF-8; returns the number of bytes written
+static size_t put_utf8(unsigned long cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Decode the character reference at `p` (which points at '&') into `out`; returns the bytes consumed
+static size_t decode_entity(const char *p, char *out, size_t *written) {
+    static const struct { const char *name; char value; } named[] = {
+        { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' }, { "&nbsp;", ' ' }
+    };
+
+    for (size_t i = 0; i < sizeof(named) / sizeof(named[0]); i++) {
+        size_t length = strlen(named[i].name);
+        if (strncmp(p, named[i].name, length) == 0) {
+            out[0] = named[i].value;
+            *written = 1;
+            return length;
+        }
+    }
+
+    if (p[1] == '#') {
+        char *end;
+        unsigned long cp = (p[2] == 'x' || p[2] == 'X') ? strtoul(p + 3, &end, 16) : strtoul(p + 2, &end, 10);
+        if (*end == ';' && end > p + 2 && cp > 0 && cp <= 0x10FFFF && !(cp >= 0xD800 && cp <= 0xDFFF)) {
+            *written = put_utf8(cp, out);  // The UTF-8 bytes are never longer than the reference itself
+            return (size_t)(end - p) + 1;
+        }
+    }
+
+    // Not a reference we understand, keep the ampersand literally
+    out[0] = '&';
+    *written = 1;
+    return 1;
+}
+
+// Return the visible text of a page: markup, comments, scripts and styles are dropped and every tag becomes a space
+char *extract_body_text(arena *scratch, const char *html, size_t *length) {
+    // Start at <body> when there is one so the title and metadata are not indexed twice
+    const char *p = html;
+    for (const char *q = html; (q = strchr(q, '<')) != NULL; q++) {
+        if (tag_is(q, "body", 0)) {
+            p = q;
+            break;
+        }
+    }
+
+    // The text is never longer than the markup it came from
+    char *out = (char *)arena_alloc(scratch, strlen(p) + 1);
+    size_t n = 0;
+    const char *name;
+
+    while (*p) {
+        size_t run = strcspn(p, "<&");
+        memcpy(out + n, p, run);
+        n += run;
+        p += run;
+
+        if (*p == '&') {
+            size_t written;
+            p += decode_entity(p, out + n, &written);
+            n += written;
+            continue;
+        }
+        if (*p != '<') break;
+
+        if (strncmp(p, "<!--", 4) == 0) {
+            const char *end = strstr(p + 4, "-->");
+            p = end ? end + 3 : p + strlen(p);
+        } else if ((name = raw_text_element(p)) != NULL) {
+            const char *end = skip_element(p, name);
+            p = end ? end : p + strlen(p);
+        } else {
+            const char *end = strchr(p, '>');
+            p = end ? end + 1 : p + strlen(p);
+        }
+        out[n++] = ' ';  // Keep words on either side of a tag apart
+    }
+
+    out[n] = '\0';
+    *length = n;
+    return out;
+}
@@ -0,0 +1,9 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stddef.h>
+#include "arena.h"
+
+char *extract_body_text(arena *scratch, const char *html, size_t *length); // Return the visible text of a page (tags, scripts, styles and comments removed)
+
+#endif
@@ -0,0 +1,343 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "tokenizer.h"
+
+#define SMALL_CODEPOINTS 0x800  // Code points below this (ASCII and two-byte UTF-8) use direct lookup tables
+
+// Class and case folding of every one- and two-byte code point, filled once by build_tables()
+static unsigned char class_table[SMALL_CODEPOINTS];
+static uint16_t fold_table[SMALL_CODEPOINTS];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// Sequence length of a UTF-8 lead byte; 0 marks continuation bytes and bytes that never start a valid sequence
+static const unsigned char utf8_length[256] = {
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+    3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3, 4,4,4,4,4,0,0,0,0,0,0,0,0,0,0,0
+};
+
+// Classes of code points above the direct tables; anything not listed is part of a word
+static const struct { uint32_t lo, hi; unsigned char cls; } wide_ranges[] = {
+    { 0x0964, 0x0965, CLASS_DELIM },       // Devanagari danda
+    { 0x2000, 0x2BFF, CLASS_DELIM },       // Spaces, punctuation, symbols, arrows, math operators, box drawing
+    { 0x2E00, 0x2E7F, CLASS_DELIM },       // Supplemental punctuation
+    { 0x3000, 0x303F, CLASS_DELIM },       // CJK symbols and punctuation
+    { 0x3040, 0x30FF, CLASS_IDEOGRAPH },   // Hiragana and Katakana
+    { 0x3400, 0x4DBF, CLASS_IDEOGRAPH },   // CJK extension A
+    { 0x4E00, 0x9FFF, CLASS_IDEOGRAPH },   // CJK unified ideographs
+    { 0xE000, 0xF8FF, CLASS_DELIM },       // Private use area
+    { 0xF900, 0xFAFF, CLASS_IDEOGRAPH },   // CJK compatibility ideographs
+    { 0xFE10, 0xFE1F, CLASS_DELIM },       // Vertical forms
+    { 0xFE30, 0xFE4F, CLASS_DELIM },       // CJK compatibility forms
+    { 0xFF00, 0xFF0F, CLASS_DELIM },       // Fullwidth punctuation
+    { 0xFF1A, 0xFF20, CLASS_DELIM },
+    { 0xFF3B, 0xFF40, CLASS_DELIM },
+    { 0xFF5B, 0xFF65, CLASS_DELIM },
+    { 0xFFF0, 0xFFFF, CLASS_DELIM },       // Specials
+    { 0x1F000, 0x1FAFF, CLASS_DELIM },     // Emoji and pictographs
+    { 0x20000, 0x2FFFF, CLASS_IDEOGRAPH }, // CJK extensions B and later
+};
+
+// Stop words in a perfect hash table; slot = (3 * first byte + 14 * last byte + length) % 32 has no collisions
+#define STOP_WORD_SLOTS 32
+static const char *const stop_word_table[STOP_WORD_SLOTS] = {
+    [5] = "the", [30] = "and", [1] = "in", [3] = "of", [16] = "to", [18] = "a", [25] = "with", [17] = "for",
+    [7] = "is", [19] = "on", [6] = "by", [10] = "this", [21] = "it", [29] = "at", [12] = "from", [11] = "or"
+};
+
+// Mark a range of small code points as word characters that fold by a fixed offset
+static void fold_range(uint32_t lo, uint32_t hi, int offset, int step) {
+    for (uint32_t cp = lo; cp <= hi; cp += step) {
+        class_table[cp] = CLASS_WORD;
+        fold_table[cp] = (uint16_t)(cp + offset);
+    }
+}
+
+// Fill the class and fold tables for ASCII, Latin, Greek and Cyrillic
+static void build_tables(void) {
+    for (uint32_t cp = 0; cp < SMALL_CODEPOINTS; cp++) {
+        class_table[cp] = cp >= 0xC0 ? CLASS_WORD : CLASS_DELIM;  // Letters dominate above Latin-1 punctuation
+        fold_table[cp] = (uint16_t)cp;
+    }
+
+    // ASCII letters, digits and underscore
+    fold_range('a', 'z', 0, 1);
+    fold_range('0', '9', 0, 1);
+    fold_range('_', '_', 0, 1);
+    fold_range('A', 'Z', 0x20, 1);
+
+    // Latin-1 letters; the multiplication and division signs are delimiters
+    fold_range(0xAA, 0xAA, 0, 1);
+    fold_range(0xB5, 0xB5, 0x3BC - 0xB5, 1);  // Micro sign folds to Greek mu
+    fold_range(0xBA, 0xBA, 0, 1);
+    fold_range(0xC0, 0xDE, 0x20, 1);
+    class_table[0xD7] = CLASS_DELIM;
+    class_table[0xF7] = CLASS_DELIM;
+    fold_table[0xD7] = 0xD7;
+
+    // Latin Extended-A pairs upper/lower case on alternating code points
+    fold_range(0x100, 0x137, 1, 2);
+    fold_table[0x130] = 'i';  // Capital I with dot above is a Turkish capital i, not a capital of dotless i
+    fold_range(0x139, 0x148, 1, 2);
+    fold_range(0x14A, 0x177, 1, 2);
+    fold_range(0x178, 0x178, 0xFF - 0x178, 1);
+    fold_range(0x179, 0x17E, 1, 2);
+
+    // Greek, including accented capitals and the final sigma
+    fold_range(0x386, 0x386, 0x3AC - 0x386, 1);
+    fold_range(0x388, 0x38A, 0x3AD - 0x388, 1);
+    fold_range(0x38C, 0x38C, 0x3CC - 0x38C, 1);
+    fold_range(0x38E, 0x38F, 0x3CD - 0x38E, 1);
+    fold_range(0x391, 0x3AB, 0x20, 1);
+    fold_range(0x3C2, 0x3C2, 1, 1);
+    class_table[0x37E] = CLASS_DELIM;  // Greek question mark
+    class_table[0x387] = CLASS_DELIM;  // Greek ano teleia
+
+    // Cyrillic
+    fold_range(0x400, 0x40F, 0x50, 1);
+    fold_range(0x410, 0x42F, 0x20, 1);
+    fold_range(0x460, 0x480, 1, 2);
+    fold_range(0x48A, 0x4BE, 1, 2);
+    class_table[0x482] = CLASS_DELIM;  // Cyrillic thousands sign
+
+    // Armenian, Hebrew and Arabic punctuation
+    class_table[0x55A] = class_table[0x55B] = class_table[0x55C] = class_table[0x55D] = class_table[0x55E] = CLASS_DELIM;
+    class_table[0x589] = class_table[0x5BE] = class_table[0x5C0] = class_table[0x5C3] = CLASS_DELIM;
+    class_table[0x60C] = class_table[0x61B] = class_table[0x61F] = class_table[0x6D4] = CLASS_DELIM;
+}
+
+// Class of a code point
+static unsigned char codepoint_class(uint32_t cp) {
+    if (cp < SMALL_CODEPOINTS) return class_table[cp];
+
+    int lo = 0, hi = (int)(sizeof(wide_ranges) / sizeof(wide_ranges[0])) - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (cp < wide_ranges[mid].lo) hi = mid - 1;
+        else if (cp > wide_ranges[mid].hi) lo = mid + 1;
+        else return wide_ranges[mid].cls;
+    }
+    return CLASS_WORD;
+}
+
+// Case fold of a code point
+static uint32_t codepoint_fold(uint32_t cp) {
+    if (cp < SMALL_CODEPOINTS) return fold_table[cp];
+    if (cp >= 0xFF21 && cp <= 0xFF3A) return cp + 0x20;  // Fullwidth Latin capitals
+    return cp;
+}
+
+// Decode the UTF-8 sequence at `p`; returns its length, or 0 if it is malformed or truncated
+static size_t decode(const unsigned char *p, const unsigned char *end, uint32_t *cp) {
+    size_t length = utf8_length[*p];
+    if (length == 0 || (size_t)(end - p) < length) return 0;
+
+    uint32_t value;
+    switch (length) {
+        case 1:
+            *cp = *p;
+            return 1;
+        case 2:
+            if ((p[1] & 0xC0) != 0x80) return 0;
+            value = ((uint32_t)(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+            break;
+        case 3:
+            if ((p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80) return 0;
+            value = ((uint32_t)(p[0] & 0x0F) << 12) | ((uint32_t)(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+            if (value < 0x800 || (value >= 0xD800 && value <= 0xDFFF)) return 0;  // Overlong or surrogate
+            break;
+        default:
+            if ((p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80) return 0;
+            value = ((uint32_t)(p[0] & 0x07) << 18) | ((uint32_t)(p[1] & 0x3F) << 12) |
+                    ((uint32_t)(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+            if (value < 0x10000 || value > 0x10FFFF) return 0;
+            break;
+    }
+    *cp = value;
+    return length;
+}
+
+// Encode a code point as UTF-8; returns the number of bytes written
+static size_t encode(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+#ifdef __SSE2__
+// Classify 16 bytes at once: sets a bit per ASCII word byte in *word and per non-ASCII byte in *high,
+// and returns the bytes with ASCII capitals folded to lower case
+static __m128i classify16(const unsigned char *p, unsigned *word, unsigned *high) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+    // Signed compares leave bytes >= 0x80 out of every range
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+
+    *word = (unsigned)_mm_movemask_epi8(_mm_or_si128(alpha, _mm_or_si128(digit, underscore)));
+    *high = (unsigned)_mm_movemask_epi8(v);
+    return _mm_or_si128(v, _mm_and_si128(alpha, _mm_set1_epi8(0x20)));
+}
+#endif
+
+// Start tokenizing `length` bytes of UTF-8 text
+void tokenizer_init(tokenizer *tk, const char *text, size_t length) {
+    pthread_once(&tables_once, build_tables);
+    tk->pos = (const unsigned char *)text;
+    tk->end = tk->pos + length;
+}
+
+// Write the next case-folded token to `out` (TOKEN_MAX + 1 bytes); returns its length, or 0 at the end of the input
+size_t next_token(tokenizer *tk, char *out) {
+    const unsigned char *p = tk->pos;
+    const unsigned char *end = tk->end;
+    size_t n = 0;
+    size_t limit = TOKEN_MAX;  // Lowered to `n` once a character no longer fits, truncating the token
+
+    while (p < end) {
+#ifdef __SSE2__
+        // Sixteen bytes at a time: skip delimiters before a token and copy folded ASCII word runs
+        while (end - p >= 16) {
+            unsigned word, high;
+            __m128i folded = classify16(p, &word, &high);
+
+            if (n == 0) {
+                int skip = __builtin_ctz(word | high | 0x10000);  // Leading delimiters
+                if (skip > 0) {
+                    p += skip;
+                    continue;
+                }
+            }
+
+            int run = __builtin_ctz(~word | 0x10000);
+            if (n + 16 <= limit) {
+                _mm_storeu_si128((__m128i *)(out + n), folded);  // Bytes past the run are overwritten or ignored
+                n += run;
+            } else {
+                unsigned char block[16];
+                _mm_storeu_si128((__m128i *)block, folded);
+                size_t keep = limit - n < (size_t)run ? limit - n : (size_t)run;
+                memcpy(out + n, block, keep);
+                n += keep;
+            }
+            p += run;
+            if (run < 16) break;  // Delimiter or non-ASCII byte, handled one character at a time below
+        }
+#else
+        // Eight ASCII bytes at a time: one mask test replaces the UTF-8 decoder, then the tables do the rest
+        while (end - p >= 8) {
+            uint64_t block;
+            memcpy(&block, p, sizeof(block));
+            if (block & 0x8080808080808080ULL) break;
+
+            int i = 0;
+            while (i < 8 && class_table[p[i]] == CLASS_WORD) {
+                if (n < limit) out[n++] = (char)fold_table[p[i]];
+                i++;
+            }
+            p += i;
+            if (i < 8) break;
+        }
+#endif
+        if (p >= end) break;
+
+        unsigned char b = *p;
+        if (b < 0x80) {
+            if (class_table[b] == CLASS_WORD) {
+                if (n < limit) out[n++] = (char)fold_table[b];
+                p++;
+                continue;
+            }
+
+            // An apostrophe between two letters stays inside the word ("don't")
+            if (b == '\'' && n > 0 && p + 1 < end && p[1] < 0x80 && class_table[p[1]] == CLASS_WORD) {
+                if (n < limit) out[n++] = '\'';
+                p++;
+                continue;
+            }
+
+            p++;
+            if (n > 0) break;  // A delimiter ends the current token
+            continue;
+        }
+
+        uint32_t cp;
+        size_t length = decode(p, end, &cp);
+        if (length == 0) {
+            p++;  // Malformed byte, treat it as a delimiter
+            if (n > 0) break;
+            continue;
+        }
+
+        unsigned char cls = codepoint_class(cp);
+        if (cls == CLASS_DELIM) {
+            p += length;
+            if (n > 0) break;
+            continue;
+        }
+        if (cls == CLASS_IDEOGRAPH) {
+            if (n > 0) break;  // Leave the ideograph for the next call
+            n = encode(cp, out);
+            p += length;
+            break;
+        }
+
+        char folded[4];
+        size_t folded_length = encode(codepoint_fold(cp), folded);
+        if (n + folded_length <= limit) {
+            memcpy(out + n, folded, folded_length);
+            n += folded_length;
+        } else {
+            limit = n;  // Never keep part of a character
+        }
+        p += length;
+    }
+
+    tk->pos = p;
+    out[n] = '\0';
+    return n;
+}
+
+// Case-fold a single word (e.g. a search query) the same way tokens are folded; returns the folded length
+size_t fold_word(const char *word, char *out) {
+    tokenizer tk;
+    tokenizer_init(&tk, word, strlen(word));
+    return next_token(&tk, out);
+}
+
+// Check a folded token against the stop-word set with a single probe
+int is_stop_word(const char *word, size_t length) {
+    if (length == 0) return 0;
+
+    unsigned slot = (3u * (unsigned char)word[0] + 14u * (unsigned char)word[length - 1] + (unsigned)length) % STOP_WORD_SLOTS;
+    const char *candidate = stop_word_table[slot];
+    return candidate && strlen(candidate) == length && memcmp(candidate, word, length) == 0;
+}
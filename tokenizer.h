@@ -0,0 +1,24 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h>
+
+#define TOKEN_MAX 64  // Longest token in bytes; longer words are truncated at a character boundary
+
+// Character classes used by the tokenizer tables
+#define CLASS_DELIM 0       // Separates tokens
+#define CLASS_WORD 1        // Part of a word
+#define CLASS_IDEOGRAPH 2   // CJK character indexed as a token on its own
+
+// State of a tokenizer walking over a UTF-8 buffer
+typedef struct tokenizer {
+    const unsigned char *pos;  // Next byte to examine
+    const unsigned char *end;  // One past the last byte of the input
+} tokenizer;
+
+void tokenizer_init(tokenizer *tk, const char *text, size_t length); // Start tokenizing `length` bytes of UTF-8 text
+size_t next_token(tokenizer *tk, char *out); // Write the next case-folded token (at most TOKEN_MAX bytes plus '\0') to `out`; returns its length or 0 at the end
+size_t fold_word(const char *word, char *out); // Case-fold a single word (e.g. a search query) the same way tokens are folded
+int is_stop_word(const char *word, size_t length); // Check a folded token against the stop-word set
+
+#endif
@@ -2,30 +2,29 @@
 #include <string.h>
 #include <stdio.h>
 #include "trie.h"
-#include <ctype.h>
+#include "tokenizer.h"
 
 // Function to initialize the trie data structure
 void init_trie(trie *t) {
-    // Allocate memory for the root node
-    t->root = (trie_node*)malloc(sizeof(trie_node));
+    // Every node and URL list entry is carved out of the trie's arena
+    arena_init(&t->pool, 0);
 
-    // Initialize all child nodes of the root to NULL
-    for (int i = 0; i < MAX_CHILDREN; i++) {
-        t->root->children[i] = NULL;
-    }
-
-    // Set the character for the root node to '\0'
-    t->root->c = '\0';
+    // Allocate the root node, which stores the character '\0'
+    t->root = create_node(&t->pool, '\0');
+    return;
+}
 
-    // Initialize the URL list for the root node as an empty list
-    init_SLL(&(t->root->url_list));
+// Function to free the whole trie; all nodes live in its arena so this is a single release
+void free_trie(trie *t) {
+    arena_free(&t->pool);
+    t->root = NULL;
     return;
 }
 
 // Function to update the URL list for a trie node
-void update_url_list(trie_node *node, char *url) {
+void update_url_list(trie *t, trie_node *node, char *url) {
     // Append the URL to the node's URL list
-    append(&(node->url_list), url);
+    append(&(node->url_list), url, &t->pool);
     return;
 }
 
@@ -35,6 +34,11 @@ int get_index(char key) {
     if (key >= 97 && key <= 122) {
         return (int)key - 97;
     }
+
+    // Handle digits (0-9)
+    if (key >= '0' && key <= '9') {
+        return (int)(key - '0') + 26;
+    }
     
     // Handle special characters for end of word and specific symbols
     if (key == '\0') return MAX_CHILDREN - 1;
@@ -46,20 +50,28 @@ int get_index(char key) {
     return -1;
 }
 
-// Function to display the URL list for a trie node
-void display_url_list(trie_node *node) {
-    // If the node has no URL list, display a message
-    if (!node->url_list) {
-        printf("The list is empty.\n");
-        return;
+// Function to find the child reached through byte `key`, creating it when `create` is set
+trie_node *get_child(trie *t, trie_node *node, char key, int create) {
+    int index = get_index(key);
+    if (index != -1) {
+        if (!node->children[index] && create) {
+            node->children[index] = create_node(&t->pool, key);
+        }
+        return node->children[index];
     }
 
-    // Traverse and print each URL in the node's URL list
-    sll_node *current = node->url_list;
-    while (current) {
-        printf("%s\n", current->url);
-        current = current->next;
+    // Bytes of multi-byte UTF-8 characters are kept in a short sibling list
+    if ((unsigned char)key < 0x80) return NULL;
+    trie_node *child;
+    for (child = node->extra; child; child = child->sibling) {
+        if (child->c == key) return child;
     }
+    if (!create) return NULL;
+
+    child = create_node(&t->pool, key);
+    child->sibling = node->extra;
+    node->extra = child;
+    return child;
 }
 
 // Function to insert a keyword and associated URL into the trie
@@ -72,67 +84,59 @@ void insert_trie(trie *t, char *keyword, char *url) {
 
     // Traverse through the keyword and build the trie
     for (char *c = keyword; *c != '\0'; c++) {
-        int index = get_index(*c);
+        // Find the child for this byte, creating it if it doesn't exist
+        trie_node *child = get_child(t, current_node, *c, 1);
         
         // Skip invalid characters
-        if (index == -1) {
+        if (!child) {
             return;
         }
 
-        // Create a new node if the corresponding child doesn't exist
-        if (!current_node->children[index]) {
-            current_node->children[index] = create_node(*c);
-        }
-
         // Move to the child node
-        current_node = current_node->children[index];
+        current_node = child;
     }
 
     // Update the URL list for the final node of the keyword
-    update_url_list(current_node, url);
+    update_url_list(t, current_node, url);
     return;
 }
 
-// Function to search for a keyword in the trie and display associated URLs
-void search_trie(trie *t, char *keyword) {
+// Function to find the URL list of a keyword; returns NULL if the keyword was never indexed
+SLL lookup_trie(trie *t, char *keyword) {
     // Return if the trie or any required parameters are NULL or invalid
     if (!t || !t->root || !keyword || *keyword == '\0') {
-        return; // Invalid input or empty keyword
+        return NULL; // Invalid input or empty keyword
     }
     
-    // Convert the keyword to lowercase
-    for (char *p = keyword; *p; p++) *p = tolower(*p);
+    // Case-fold the keyword exactly like indexed tokens
+    char folded[TOKEN_MAX + 1];
+    if (fold_word(keyword, folded) == 0) {
+        return NULL; // Nothing indexable in the keyword
+    }
 
     // Start at the root of the trie
     trie_node *current_node = t->root;
 
     // Traverse through the keyword in the trie
-    for (char *c = keyword; *c != '\0'; c++) {
-        int index = get_index(*c);
+    for (char *c = folded; *c != '\0'; c++) {
+        trie_node *child = get_child(t, current_node, *c, 0);
 
-        // If the index is invalid or the child node doesn't exist
-        if (index == -1 || !current_node->children[index]) {
-            printf("Keyword not found\n"); // Keyword doesn't exist in the Trie
-            return;
+        // If the character is invalid or the child node doesn't exist
+        if (!child) {
+            return NULL; // Keyword doesn't exist in the Trie
         }
 
         // Move to the child node
-        current_node = current_node->children[index];
-    }
-
-    // If the node has a URL list, display the associated URLs
-    if (current_node->url_list != NULL) {
-        printf("Keyword found at the following URLs:\n");
-        display_url_list(current_node);
+        current_node = child;
     }
 
-    return; // Keyword not found or no URLs associated
+    return current_node->url_list;
 }
 
 // Function to create a new trie node with a specific character
-trie_node *create_node(char key) {
-    // Allocate memory for a new trie node
-    trie_node *node = (trie_node *)malloc(sizeof(trie_node));
+trie_node *create_node(arena *pool, char key) {
+    // Allocate memory for a new trie node from the arena
+    trie_node *node = (trie_node *)arena_alloc(pool, sizeof(trie_node));
     
     // Set the character for the node
     node->c = key;
@@ -142,6 +146,9 @@ trie_node *create_node(char key) {
         node->children[i] = NULL;
     }
 
+    node->extra = NULL;
+    node->sibling = NULL;
+
     // Initialize the URL list for the new node as an empty list
     init_SLL(&(node->url_list));
     return node;
@@ -1,36 +1,35 @@
+#ifndef TRIE_H
+#define TRIE_H
+
 #include <stdlib.h>
 #include "sll.h"
-#define MAX_CHILDREN 30
+#include "arena.h"
+#define MAX_CHILDREN 40  // a-z, 0-9, four symbols; UTF-8 bytes above 0x7F use the `extra` list
 
 // Structure to represent a node in the trie
 typedef struct trie_node {
     char c;                // Character stored at this node
     SLL url_list;          // Linked list of URLs associated with this node
     struct trie_node *children[MAX_CHILDREN];  // Array of pointers to child nodes (children for each character)
+    struct trie_node *extra;    // First child reached through a non-ASCII byte of a UTF-8 word
+    struct trie_node *sibling;  // Next node in the parent's `extra` list
 } trie_node;
 
 // Structure to represent the trie (which contains the root node)
 typedef struct trie {
     trie_node *root;  // Root node of the trie
+    arena pool;       // Long-lived arena owning every node and URL list entry
 } trie;
 
 // Function prototypes
 
-void update_url_list(trie_node *node, char *url); // Updates the URL list of a given trie node by appending the URL
+void update_url_list(trie *t, trie_node *node, char *url); // Updates the URL list of a given trie node by appending the URL
 void insert_trie(trie *t, char *word, char *url); // Inserts a word into the trie along with its associated URL
-void search_trie(trie *t, char *keyword); // Searches for a keyword in the trie and displays the associated URLs
+SLL lookup_trie(trie *t, char *keyword); // Returns the URL list of a keyword, or NULL if it was never indexed
 void init_trie(trie *t); // Initializes the trie by setting the root node and other required fields
-trie_node *create_node(char key); // Creates and returns a new trie node for a given character
+void free_trie(trie *t); // Frees every node and URL list of the trie at once
+trie_node *create_node(arena *pool, char key); // Creates and returns a new trie node for a given character
 int get_index(char key); // Maps a character to an index in the children array
-void display_url_list(trie_node *node); // Displays the URL list stored in a trie node
-
-
-
-
-
-
-
-
-
-
+trie_node *get_child(trie *t, trie_node *node, char key, int create); // Returns the child reached through a byte, creating it if requested
 
+#endif